@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "board.hpp"
+#include "minimax.hpp"
+
+// evaluation terms defined in minimax.cpp
+double heuristic(Board const& board, Player player);
+double corners_captured(Board const& board, Player player);
+double stability(Board const& board, Player player);
+std::array<std::array<bool, Board::size>, Board::size> semi_stable_disks(
+    Board const& board, Player player);
+double disk_parity(Board const& board, Player player);
+double static_heuristic(Board const& board, Player player);
+double mobility(Board const& board, Player player);
+
+// search functions defined in minimax.cpp
+double minimax_depth(SearchContext& context, Board const& board,
+                     Player player, size_t depth, double alpha, double beta,
+                     std::vector<Move>* principal_variation = nullptr);
+double minimax_move(SearchContext& context, Board const& next_board,
+                    Player player, size_t depth, double alpha, double beta,
+                    std::vector<Move>* principal_variation = nullptr);
+
+//! A game phase, covering all positions with a disk count in [min, max].
+struct Phase {
+  char const* name;
+  std::size_t min_disks;
+  std::size_t max_disks;
+};
+
+Phase const phases[] = {
+    {"opening", 4, 20}, {"midgame", 21, 44}, {"endgame", 45, 64}};
+
+//! A timed evaluation term.
+struct TimedTerm {
+  char const* name;
+  std::function<double(Board const&, Player)> evaluate;
+};
+
+/*! Generates a corpus of positions from random games.
+ *
+ * Every position reached in one of the games is part of the corpus, so all
+ * game phases are represented.
+ */
+std::vector<std::pair<Board, Player>> random_positions(std::size_t games,
+                                                       unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::pair<Board, Player>> positions;
+
+  for (std::size_t game = 0; game < games; game++) {
+    Board board;
+    Player player = Player::dark;
+
+    while (!board.game_over()) {
+      Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+      auto moves = board.legal_moves(player);
+      if (moves.empty()) {
+        // the player has to pass
+        player = opponent;
+        continue;
+      }
+
+      positions.push_back({board, player});
+      board = *board.next_board(moves[rng() % moves.size()], player);
+      player = opponent;
+    }
+    positions.push_back({board, player});
+  }
+
+  return positions;
+}
+
+/*! Rates the leaves below a depth-1 node one at a time.
+ *
+ * This is how minimax_depth rated them before they were batched; it serves as
+ * the reference the batched search has to beat.
+ */
+double scalar_leaves(Board const& board, Player player, double alpha,
+                     double beta) {
+  SearchContext context;
+  double best_value = alpha;
+  for (auto const& next : board.next_boards(player)) {
+    double value = minimax_move(context, next.second, player, 0, alpha, beta);
+    best_value = std::max(best_value, value);
+    alpha = std::max(alpha, value);
+    if (beta <= alpha) {
+      break;
+    }
+  }
+  return best_value;
+}
+
+//! Returns the p-th percentile of a sorted sample.
+double percentile(std::vector<double> const& sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return sorted[std::min(sorted.size() - 1,
+                         static_cast<std::size_t>(p * sorted.size()))];
+}
+
+/*! Times the evaluation terms over a corpus of random positions.
+ *
+ * Usage: bench_heuristic [games] [repetitions]
+ *
+ * Each term is evaluated `repetitions` times per position; the averaged time
+ * per call is reported as mean and percentiles for each game phase.  Then
+ * the leaves below depth-1 nodes are rated by the batched search and by the
+ * scalar reference, with a full and with a narrow window.
+ */
+int main(int argc, char** argv) {
+  std::size_t const games = (argc > 1) ? std::atoi(argv[1]) : 20;
+  std::size_t const reps = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+  auto positions = random_positions(games, 42);
+
+  std::vector<TimedTerm> const terms = {
+      {"corners_captured", corners_captured},
+      {"stability", stability},
+      {"semi_stable_disks",
+       [](Board const& board, Player player) {
+         return semi_stable_disks(board, player)[0][0] ? 1. : 0.;
+       }},
+      {"disk_parity", disk_parity},
+      {"static_heuristic", static_heuristic},
+      {"mobility", mobility},
+      {"heuristic", heuristic}};
+
+  // keeps the compiler from discarding the evaluations
+  volatile double sink = 0;
+
+  std::cout << positions.size() << " positions, " << reps
+            << " repetitions per position" << std::endl
+            << std::endl;
+  std::cout << std::left << std::setw(20) << "term" << std::setw(10)
+            << "phase" << std::right << std::setw(8) << "calls"
+            << std::setw(12) << "mean ns" << std::setw(12) << "p50 ns"
+            << std::setw(12) << "p90 ns" << std::setw(12) << "p99 ns"
+            << std::endl;
+
+  for (TimedTerm const& term : terms) {
+    for (Phase const& phase : phases) {
+      std::vector<double> times;
+
+      for (auto const& position : positions) {
+        Board const& board = position.first;
+        Player player = position.second;
+        std::size_t disks = board.disk_no();
+        if (disks < phase.min_disks || disks > phase.max_disks) {
+          continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t rep = 0; rep < reps; rep++) {
+          sink = sink + term.evaluate(board, player);
+        }
+        std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        times.push_back(elapsed.count() / reps);
+      }
+
+      std::sort(times.begin(), times.end());
+      double mean = 0;
+      for (double time : times) {
+        mean += time / times.size();
+      }
+
+      std::cout << std::left << std::setw(20) << term.name << std::setw(10)
+                << phase.name << std::right << std::setw(8)
+                << times.size() * reps << std::fixed << std::setprecision(1)
+                << std::setw(12) << mean << std::setw(12)
+                << percentile(times, .5) << std::setw(12)
+                << percentile(times, .9) << std::setw(12)
+                << percentile(times, .99) << std::endl;
+    }
+  }
+
+  double constexpr infinity = std::numeric_limits<double>::infinity();
+  struct Window {
+    char const* name;
+    double alpha;
+    double beta;
+  };
+  Window const windows[] = {{"full", -infinity, infinity},
+                            {"narrow", -0.05, 0.05}};
+
+  std::cout << std::endl
+            << std::left << std::setw(20) << "depth-1 window" << std::setw(10)
+            << "phase" << std::right << std::setw(8) << "nodes"
+            << std::setw(12) << "scalar ns" << std::setw(12) << "batch ns"
+            << std::setw(12) << "speedup" << std::endl;
+
+  for (Window const& window : windows) {
+    for (Phase const& phase : phases) {
+      std::chrono::duration<double, std::nano> scalar_time(0);
+      std::chrono::duration<double, std::nano> batch_time(0);
+      std::size_t nodes = 0;
+
+      for (auto const& position : positions) {
+        Board const& board = position.first;
+        Player player = position.second;
+        std::size_t disks = board.disk_no();
+        if (disks < phase.min_disks || disks > phase.max_disks ||
+            board.legal_moves(player).empty()) {
+          continue;
+        }
+        nodes++;
+
+        double scalar_value = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t rep = 0; rep < reps; rep++) {
+          scalar_value =
+              scalar_leaves(board, player, window.alpha, window.beta);
+        }
+        scalar_time += std::chrono::steady_clock::now() - start;
+
+        double batch_value = 0;
+        start = std::chrono::steady_clock::now();
+        for (std::size_t rep = 0; rep < reps; rep++) {
+          SearchContext context;
+          batch_value = minimax_depth(context, board, player, 1, window.alpha,
+                                      window.beta);
+        }
+        batch_time += std::chrono::steady_clock::now() - start;
+
+        if (batch_value != scalar_value) {
+          std::cerr << "batched search differs from scalar reference"
+                    << std::endl;
+          return 1;
+        }
+      }
+
+      double const calls = std::max<std::size_t>(nodes * reps, 1);
+      std::cout << std::left << std::setw(20) << window.name << std::setw(10)
+                << phase.name << std::right << std::setw(8) << nodes * reps
+                << std::fixed << std::setprecision(1) << std::setw(12)
+                << scalar_time.count() / calls << std::setw(12)
+                << batch_time.count() / calls << std::setprecision(2)
+                << std::setw(12) << scalar_time / batch_time << std::endl;
+    }
+  }
+}
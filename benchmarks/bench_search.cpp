@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "board.hpp"
+#include "minimax.hpp"
+
+//! A position of the suite, searched to a fixed depth.
+struct Position {
+  char const* name;
+
+  //! Seed of the random game leading to the position.
+  unsigned seed;
+
+  //! Number of disks on the board.
+  std::size_t disks;
+
+  std::size_t depth;
+};
+
+Position const suite[] = {
+    {"midgame-1", 1, 24, 4}, {"midgame-2", 2, 32, 4},
+    {"midgame-3", 3, 40, 4}, {"endgame-1", 4, 50, 5},
+    {"endgame-2", 5, 54, 10}};
+
+//! Number of searches per position; the fastest one is reported.
+std::size_t constexpr repetitions = 3;
+
+//! Measurements of a single position.
+struct Measurement {
+  std::size_t depth;
+  unsigned long long nodes;
+  double milliseconds;
+  std::string move;
+
+  double nps() const { return nodes / (milliseconds / 1000); }
+};
+
+/*! Speed of a search which does not depend on the engine.
+ *
+ * Dividing the NPS of the suite by the NPS of the calibration gives a
+ * throughput which varies far less between machines than either.
+ */
+struct Calibration {
+  unsigned long long nodes = 0;
+  double milliseconds = 0;
+
+  double nps() const { return nodes / (milliseconds / 1000); }
+};
+
+//! Stored measurements and the deviations tolerated from them.
+struct Baseline {
+  //! Fraction by which the node count may grow.
+  double node_tolerance = 0.1;
+
+  //! Factor by which the time to depth may grow and the NPS may drop.
+  double time_tolerance = 1.5;
+
+  //! NPS of the calibration search when the baseline was recorded.
+  double calibration_nps = 0;
+
+  std::map<std::string, Measurement> positions;
+};
+
+/*! Plays a random game until the given number of disks is on the board.
+ *
+ * Returns the board and the player to move.  Random numbers are used in a
+ * way which does not depend on the standard library, so the positions are
+ * the same everywhere.
+ */
+std::pair<Board, Player> random_position(unsigned seed, std::size_t disks) {
+  std::mt19937 rng(seed);
+  Board board;
+  Player player = Player::dark;
+
+  while (board.disk_no() < disks && !board.game_over()) {
+    Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+    auto moves = board.legal_moves(player);
+    if (!moves.empty()) {
+      board = *board.next_board(moves[rng() % moves.size()], player);
+    }
+    player = opponent;
+  }
+
+  if (board.legal_moves(player).empty()) {
+    // the player has to pass
+    player = (player == Disk::dark) ? Disk::light : Disk::dark;
+  }
+
+  return {board, player};
+}
+
+std::string move_name(Move move) {
+  return {static_cast<char>('a' + move.first),
+          static_cast<char>('0' + move.second)};
+}
+
+/*! Searches the complete game tree of tic-tac-toe.
+ *
+ * Returns the value of the position for the player to move and counts the
+ * positions searched.
+ */
+int calibration_search(std::array<int, 9>& squares, int player,
+                       unsigned long long& nodes) {
+  static int const lines[8][3] = {{0, 1, 2}, {3, 4, 5}, {6, 7, 8},
+                                  {0, 3, 6}, {1, 4, 7}, {2, 5, 8},
+                                  {0, 4, 8}, {2, 4, 6}};
+  nodes++;
+
+  for (auto const& line : lines) {
+    if (squares[line[0]] && squares[line[0]] == squares[line[1]] &&
+        squares[line[0]] == squares[line[2]]) {
+      return squares[line[0]] * player;
+    }
+  }
+
+  int best = -2;
+  for (int& square : squares) {
+    if (!square) {
+      square = player;
+      best = std::max(best, -calibration_search(squares, -player, nodes));
+      square = 0;
+    }
+  }
+
+  // a full board without a line is a draw
+  return best == -2 ? 0 : best;
+}
+
+/*! Searches a position of the suite repeatedly and reports the fastest run.
+ *
+ * The calibration search is run alongside, so that both see the same load,
+ * and its fastest run is added to calibration.
+ */
+Measurement measure(Position const& position, Calibration& calibration) {
+  auto start_position = random_position(position.seed, position.disks);
+
+  Measurement measurement;
+  measurement.depth = position.depth;
+
+  unsigned long long calibration_nodes = 0;
+  double calibration_milliseconds = 0;
+
+  for (std::size_t rep = 0; rep < repetitions; rep++) {
+    std::array<int, 9> squares = {};
+    calibration_nodes = 0;
+    auto calibration_start = std::chrono::steady_clock::now();
+    calibration_search(squares, 1, calibration_nodes);
+    std::chrono::duration<double, std::milli> calibration_elapsed =
+        std::chrono::steady_clock::now() - calibration_start;
+    if (rep == 0 || calibration_elapsed.count() < calibration_milliseconds) {
+      calibration_milliseconds = calibration_elapsed.count();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto ranking = minimax_analysis(
+        start_position.first, start_position.second, 1,
+        std::chrono::hours(24), position.depth, &measurement.nodes);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    // the search is deterministic, only the time varies
+    measurement.move = move_name(ranking.front().move);
+    if (rep == 0 || elapsed.count() < measurement.milliseconds) {
+      measurement.milliseconds = elapsed.count();
+    }
+  }
+
+  calibration.nodes += calibration_nodes;
+  calibration.milliseconds += calibration_milliseconds;
+  return measurement;
+}
+
+/*! Reads a baseline file.
+ *
+ * Lines starting with # are comments.  All other lines are either
+ *   node_tolerance <fraction>
+ *   time_tolerance <factor>
+ *   calibration_nps <nps>
+ * or the measurements of a position
+ *   <name> <depth> <nodes> <milliseconds> <move>
+ */
+bool read_baseline(std::string const& path, Baseline& baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    if (!(fields >> key) || key[0] == '#') {
+      continue;
+    }
+
+    if (key == "node_tolerance") {
+      fields >> baseline.node_tolerance;
+    } else if (key == "time_tolerance") {
+      fields >> baseline.time_tolerance;
+    } else if (key == "calibration_nps") {
+      fields >> baseline.calibration_nps;
+    } else {
+      Measurement& measurement = baseline.positions[key];
+      fields >> measurement.depth >> measurement.nodes >>
+          measurement.milliseconds >> measurement.move;
+    }
+
+    if (!fields) {
+      std::cerr << path << ": malformed line: " << line << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool write_baseline(std::string const& path, Baseline const& baseline) {
+  std::ofstream file(path);
+  file << "# Search regression baseline, written by bench_search --record."
+       << std::endl
+       << "# <name> <depth> <nodes> <milliseconds> <move>" << std::endl
+       << "# Only the calibrated NPS of the whole suite is checked by default;"
+       << std::endl
+       << "# the times of the positions are checked by bench_search --timing."
+       << std::endl
+       << "node_tolerance " << baseline.node_tolerance << std::endl
+       << "time_tolerance " << baseline.time_tolerance << std::endl
+       << "calibration_nps " << std::fixed << std::setprecision(0)
+       << baseline.calibration_nps << std::endl;
+  for (Position const& position : suite) {
+    Measurement const& measurement = baseline.positions.at(position.name);
+    file << position.name << ' ' << measurement.depth << ' '
+         << measurement.nodes << ' ' << std::fixed << std::setprecision(1)
+         << measurement.milliseconds << ' ' << measurement.move << std::endl;
+  }
+  return static_cast<bool>(file);
+}
+
+/*! Lists the ways in which a measurement falls short of its baseline.
+ *
+ * The time to depth and the NPS are only compared if timing is set.
+ */
+std::vector<std::string> regressions(Measurement const& measurement,
+                                     Measurement const& expected,
+                                     Baseline const& baseline, bool timing) {
+  std::vector<std::string> failures;
+  if (measurement.depth != expected.depth) {
+    failures.push_back("depth differs from baseline");
+    return failures;
+  }
+  if (measurement.nodes > expected.nodes * (1 + baseline.node_tolerance)) {
+    failures.push_back("node count");
+  }
+  if (timing && measurement.milliseconds >
+                    expected.milliseconds * baseline.time_tolerance) {
+    failures.push_back("time to depth");
+  }
+  if (timing && measurement.nps() < expected.nps() / baseline.time_tolerance) {
+    failures.push_back("nodes per second");
+  }
+  if (measurement.move != expected.move) {
+    failures.push_back("chosen move");
+  }
+  return failures;
+}
+
+void write_measurement(std::ostream& out, Measurement const& measurement) {
+  out << "{\"depth\": " << measurement.depth
+      << ", \"nodes\": " << measurement.nodes << ", \"milliseconds\": "
+      << std::fixed << std::setprecision(1) << measurement.milliseconds
+      << ", \"nps\": " << std::setprecision(0) << measurement.nps()
+      << ", \"move\": \"" << measurement.move << "\"}";
+}
+
+/*! Searches a fixed suite of positions and compares it to a baseline.
+ *
+ * Usage: bench_search [--record] [--timing] <baseline> [report]
+ *
+ * Every position is searched to a fixed depth.  By default, which is how
+ * the check target runs it, three things are checked:
+ *  - the node count of a position may exceed the baseline by node_tolerance,
+ *  - the chosen move of a position has to be the same, and
+ *  - the NPS of the whole suite, divided by the NPS of a calibration search
+ *    run alongside, may fall short of the baseline by a factor of
+ *    time_tolerance.
+ * If anything regresses, the exit status is 1.  The results are written to
+ * the report file as JSON.
+ *
+ * The times of single positions depend on the machine, the build type and
+ * the load, so they are only reported by default.  With --timing, the time
+ * to depth of each position may also exceed the baseline by a factor of
+ * time_tolerance, and its NPS may fall short of it by the same factor; the
+ * baseline should then be recorded on the same machine.  Either way, it
+ * should be recorded in the build type it is checked in.
+ *
+ * With --record, the baseline is replaced by the measurements instead.
+ */
+int main(int argc, char** argv) {
+  bool record = false;
+  bool timing = false;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--record") == 0) {
+      record = true;
+    } else if (std::strcmp(argv[i], "--timing") == 0) {
+      timing = true;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty() || paths.size() > 2) {
+    std::cerr << "usage: " << argv[0]
+              << " [--record] [--timing] <baseline> [report]" << std::endl;
+    return 2;
+  }
+
+  Baseline baseline;
+  if (!read_baseline(paths[0], baseline) && !record) {
+    std::cerr << "cannot read baseline " << paths[0] << std::endl;
+    return 2;
+  }
+
+  std::cout << std::left << std::setw(12) << "position" << std::right
+            << std::setw(6) << "depth" << std::setw(12) << "nodes"
+            << std::setw(10) << "ms" << std::setw(12) << "nps"
+            << std::setw(6) << "move" << "  result" << std::endl;
+
+  std::ostringstream report;
+  report << "{\"positions\": [";
+
+  bool passed = true;
+  std::map<std::string, Measurement> measurements;
+  Calibration calibration;
+  for (Position const& position : suite) {
+    Measurement measurement = measure(position, calibration);
+    measurements[position.name] = measurement;
+
+    std::vector<std::string> failures;
+    auto expected = baseline.positions.find(position.name);
+    if (record) {
+      // nothing to compare to
+    } else if (expected == baseline.positions.end()) {
+      failures.push_back("missing from baseline");
+    } else {
+      failures = regressions(measurement, expected->second, baseline, timing);
+    }
+    passed = passed && failures.empty();
+
+    std::cout << std::left << std::setw(12) << position.name << std::right
+              << std::setw(6) << measurement.depth << std::setw(12)
+              << measurement.nodes << std::fixed << std::setprecision(1)
+              << std::setw(10) << measurement.milliseconds
+              << std::setprecision(0) << std::setw(12) << measurement.nps()
+              << std::setw(6) << measurement.move << "  ";
+    if (failures.empty()) {
+      std::cout << "ok";
+    }
+    for (std::size_t i = 0; i < failures.size(); i++) {
+      std::cout << (i ? ", " : "") << failures[i];
+    }
+    std::cout << std::endl;
+
+    if (&position != suite) {
+      report << ", ";
+    }
+    report << "{\"name\": \"" << position.name << "\", \"measured\": ";
+    write_measurement(report, measurement);
+    if (expected != baseline.positions.end()) {
+      report << ", \"baseline\": ";
+      write_measurement(report, expected->second);
+    }
+    report << ", \"regressions\": [";
+    for (std::size_t i = 0; i < failures.size(); i++) {
+      report << (i ? ", " : "") << '"' << failures[i] << '"';
+    }
+    report << "]}";
+  }
+
+  // the throughput of the whole suite, relative to the calibration search
+  Measurement total{0, 0, 0, ""};
+  Measurement expected_total{0, 0, 0, ""};
+  bool complete = true;
+  for (Position const& position : suite) {
+    total.nodes += measurements[position.name].nodes;
+    total.milliseconds += measurements[position.name].milliseconds;
+
+    auto expected = baseline.positions.find(position.name);
+    if (expected == baseline.positions.end()) {
+      complete = false;
+    } else {
+      expected_total.nodes += expected->second.nodes;
+      expected_total.milliseconds += expected->second.milliseconds;
+    }
+  }
+  double const relative_nps = total.nps() / calibration.nps();
+  double const expected_relative_nps =
+      expected_total.nps() / baseline.calibration_nps;
+
+  std::string throughput = "ok";
+  if (record) {
+    // nothing to compare to
+  } else if (!complete || !baseline.calibration_nps) {
+    throughput = "missing from baseline";
+  } else if (relative_nps < expected_relative_nps / baseline.time_tolerance) {
+    throughput = "calibrated nodes per second";
+  }
+  passed = passed && throughput == "ok";
+
+  std::cout << std::left << std::setw(12) << "suite" << std::right
+            << std::setw(6) << "" << std::setw(12) << total.nodes
+            << std::setprecision(1) << std::setw(10) << total.milliseconds
+            << std::setprecision(0) << std::setw(12) << total.nps()
+            << std::setw(6) << "" << std::endl
+            << std::left << std::setw(12) << "calibration" << std::right
+            << std::setw(6) << "" << std::setw(12) << calibration.nodes
+            << std::setprecision(1) << std::setw(10)
+            << calibration.milliseconds << std::setprecision(0)
+            << std::setw(12) << calibration.nps() << std::endl
+            << "calibrated nps " << std::setprecision(6) << relative_nps;
+  if (!record) {
+    std::cout << ", baseline " << expected_relative_nps << "  " << throughput;
+  }
+  std::cout << std::endl;
+
+  report << "], \"calibration_nps\": " << std::setprecision(0)
+         << calibration.nps()
+         << ", \"baseline_calibration_nps\": " << baseline.calibration_nps
+         << ", \"calibrated_nps\": " << std::setprecision(6) << relative_nps
+         << ", \"baseline_calibrated_nps\": " << expected_relative_nps
+         << ", \"throughput\": \"" << throughput << '"'
+         << ", \"node_tolerance\": " << std::setprecision(2)
+         << baseline.node_tolerance
+         << ", \"time_tolerance\": " << baseline.time_tolerance
+         << ", \"timing\": " << (timing ? "true" : "false")
+         << ", \"passed\": " << (passed ? "true" : "false") << "}";
+
+  if (paths.size() > 1) {
+    std::ofstream(paths[1]) << report.str() << std::endl;
+  }
+
+  if (record) {
+    baseline.positions = measurements;
+    baseline.calibration_nps = calibration.nps();
+    if (!write_baseline(paths[0], baseline)) {
+      std::cerr << "cannot write baseline " << paths[0] << std::endl;
+      return 2;
+    }
+    return 0;
+  }
+
+  return passed ? 0 : 1;
+}
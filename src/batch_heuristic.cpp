@@ -0,0 +1,288 @@
+#include "batch_heuristic.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include "minimax.hpp"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define REVERSI_X86_DISPATCH
+#endif
+
+double stability(Board const& board, Player player);
+boost::optional<double> rating_bound(double partial, double remaining_weight,
+                                     double alpha, double beta);
+
+namespace {
+
+//! Maximum number of boards summed together.
+std::size_t constexpr max_lanes = 8;
+
+//! Computes the square sums of as many boards as it has lanes.
+struct SquareSumsKernel {
+  std::size_t lanes;
+  void (*sums)(Board const* boards, SquareSums* sums);
+};
+
+#ifdef REVERSI_X86_DISPATCH
+static_assert(sizeof(Disk) == sizeof(std::int32_t),
+              "vector kernels expect squares to be 32 bit wide");
+
+/*! Sums the squares of four boards, one board per lane.
+ *
+ * SSE2 is part of x86-64, so this kernel is always available.
+ */
+void square_sums_sse2(Board const* boards, SquareSums* sums) {
+  __m128i const one = _mm_set1_epi32(1);
+  __m128i const minus_one = _mm_set1_epi32(-1);
+
+  __m128i disk_diff = _mm_setzero_si128();
+  __m128i disks = _mm_setzero_si128();
+  __m128i dark_value = _mm_setzero_si128();
+  __m128i light_value = _mm_setzero_si128();
+
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y += 4) {
+      __m128i rows[4];
+      for (std::size_t lane = 0; lane < 4; lane++) {
+        rows[lane] = _mm_loadu_si128(
+            reinterpret_cast<__m128i const*>(&boards[lane][x][y]));
+      }
+
+      // transpose, so that each vector holds one square of all four boards
+      __m128i const t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+      __m128i const t1 = _mm_unpacklo_epi32(rows[2], rows[3]);
+      __m128i const t2 = _mm_unpackhi_epi32(rows[0], rows[1]);
+      __m128i const t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+      __m128i const squares[4] = {
+          _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+          _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)};
+
+      for (std::size_t i = 0; i < 4; i++) {
+        __m128i const value = _mm_set1_epi32(static_values[x][y + i]);
+
+        disk_diff = _mm_add_epi32(disk_diff, squares[i]);
+        // dark (1) and light (-1) squares both have their lowest bit set
+        disks = _mm_add_epi32(disks, _mm_and_si128(squares[i], one));
+        dark_value = _mm_add_epi32(
+            dark_value, _mm_and_si128(value, _mm_cmpeq_epi32(squares[i], one)));
+        light_value = _mm_add_epi32(
+            light_value,
+            _mm_and_si128(value, _mm_cmpeq_epi32(squares[i], minus_one)));
+      }
+    }
+  }
+
+  alignas(16) std::int32_t lanes[4][4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes[0]), disk_diff);
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes[1]), disks);
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes[2]), dark_value);
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes[3]), light_value);
+  for (std::size_t lane = 0; lane < 4; lane++) {
+    sums[lane] = {lanes[0][lane], lanes[1][lane], lanes[2][lane],
+                  lanes[3][lane]};
+  }
+}
+
+//! Sums the squares of eight boards, one board per lane.
+__attribute__((target("avx2"))) void square_sums_avx2(Board const* boards,
+                                                      SquareSums* sums) {
+  __m256i const one = _mm256_set1_epi32(1);
+  __m256i const minus_one = _mm256_set1_epi32(-1);
+
+  __m256i disk_diff = _mm256_setzero_si256();
+  __m256i disks = _mm256_setzero_si256();
+  __m256i dark_value = _mm256_setzero_si256();
+  __m256i light_value = _mm256_setzero_si256();
+
+  for (std::size_t x = 0; x < Board::size; x++) {
+    __m256i columns[8];
+    for (std::size_t lane = 0; lane < 8; lane++) {
+      columns[lane] = _mm256_loadu_si256(
+          reinterpret_cast<__m256i const*>(&boards[lane][x][0]));
+    }
+
+    // transpose, so that each vector holds one square of all eight boards
+    __m256i t[8];
+    for (std::size_t i = 0; i < 8; i += 2) {
+      t[i] = _mm256_unpacklo_epi32(columns[i], columns[i + 1]);
+      t[i + 1] = _mm256_unpackhi_epi32(columns[i], columns[i + 1]);
+    }
+    __m256i u[8];
+    for (std::size_t i = 0; i < 8; i += 4) {
+      u[i] = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+      u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+      u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+      u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    __m256i squares[8];
+    for (std::size_t i = 0; i < 4; i++) {
+      squares[i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+      squares[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+    }
+
+    for (std::size_t y = 0; y < 8; y++) {
+      __m256i const value = _mm256_set1_epi32(static_values[x][y]);
+
+      disk_diff = _mm256_add_epi32(disk_diff, squares[y]);
+      disks = _mm256_add_epi32(disks, _mm256_and_si256(squares[y], one));
+      dark_value = _mm256_add_epi32(
+          dark_value,
+          _mm256_and_si256(value, _mm256_cmpeq_epi32(squares[y], one)));
+      light_value = _mm256_add_epi32(
+          light_value,
+          _mm256_and_si256(value, _mm256_cmpeq_epi32(squares[y], minus_one)));
+    }
+  }
+
+  alignas(32) std::int32_t lanes[4][8];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), disk_diff);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), disks);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[2]), dark_value);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[3]), light_value);
+  for (std::size_t lane = 0; lane < 8; lane++) {
+    sums[lane] = {lanes[0][lane], lanes[1][lane], lanes[2][lane],
+                  lanes[3][lane]};
+  }
+}
+#else
+void square_sums_scalar(Board const* boards, SquareSums* sums) {
+  Board const& board = *boards;
+  *sums = {0, 0, 0, 0};
+
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y++) {
+      sums->disk_diff += board[x][y];
+      switch (board[x][y]) {
+        case Disk::dark:
+          sums->disks++;
+          sums->dark_value += static_values[x][y];
+          break;
+
+        case Disk::light:
+          sums->disks++;
+          sums->light_value += static_values[x][y];
+          break;
+
+        default:
+          break;
+      }
+    }
+  }
+}
+#endif
+
+//! Picks the widest square summing kernel the CPU supports.
+SquareSumsKernel select_kernel() {
+#ifdef REVERSI_X86_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return {8, square_sums_avx2};
+  }
+  return {4, square_sums_sse2};
+#else
+  return {1, square_sums_scalar};
+#endif
+}
+
+}  // namespace
+
+void square_sums_batch(Board const* boards, std::size_t count,
+                       SquareSums* sums) {
+  static SquareSumsKernel const kernel = select_kernel();
+
+  std::size_t i = 0;
+  for (; i + kernel.lanes <= count; i += kernel.lanes) {
+    kernel.sums(boards + i, sums + i);
+  }
+
+  if (i < count) {
+    // fill the lanes of the last group with copies of its last board
+    std::array<Board, max_lanes> group;
+    std::array<SquareSums, max_lanes> group_sums;
+    for (std::size_t lane = 0; lane < kernel.lanes; lane++) {
+      group[lane] = boards[std::min(i + lane, count - 1)];
+    }
+
+    kernel.sums(group.data(), group_sums.data());
+    std::copy(group_sums.begin(), group_sums.begin() + (count - i), sums + i);
+  }
+}
+
+double heuristic(Board const& board, Player player, SquareSums const& sums,
+                 double alpha, double beta) {
+  PROFILE_TERM(term_heuristic);
+
+  PROFILE_TERM(term_disk_parity);
+  double const disk_parity =
+      player * static_cast<double>(sums.disk_diff) / sums.disks;
+
+  if (static_cast<std::size_t>(sums.disks) > board.size * board.size - 4) {
+    return disk_parity;
+  }
+
+  // the move counts double as the game over check
+  double const dark_mobility = board.legal_moves(Player::dark).size();
+  double const light_mobility = board.legal_moves(Player::light).size();
+  if (!(dark_mobility + light_mobility)) {
+    return disk_parity;
+  }
+
+  PROFILE_TERM(term_corners_captured);
+  double corner_diff = 0;
+  double corners_captured = 0;
+  for (std::size_t x : {std::size_t(0), board.size - 1}) {
+    for (std::size_t y : {std::size_t(0), board.size - 1}) {
+      corner_diff += board[x][y];
+      if (board[x][y] != Disk::none) {
+        corners_captured++;
+      }
+    }
+  }
+  double const corners =
+      corners_captured ? player * corner_diff / corners_captured : 0;
+
+  PROFILE_TERM(term_static_heuristic);
+  double const value_sum = std::abs(static_cast<double>(sums.dark_value)) +
+                           std::abs(static_cast<double>(sums.light_value));
+  double const static_heuristic =
+      value_sum ? player *
+                      static_cast<double>(sums.dark_value - sums.light_value) /
+                      value_sum
+                : 0;
+
+  if (auto bound = rating_bound(
+          6 * corners + 1 * disk_parity + 5 * static_heuristic, 1 + 5, alpha,
+          beta)) {
+    return *bound;
+  }
+
+  PROFILE_TERM(term_mobility);
+  double const mobility = player * (dark_mobility - light_mobility) /
+                          (dark_mobility + light_mobility);
+  if (auto bound = rating_bound(6 * corners + 1 * disk_parity +
+                                    5 * static_heuristic + 1 * mobility,
+                                5, alpha, beta)) {
+    return *bound;
+  }
+
+  return (6 * corners + 5 * stability(board, player) + 1 * disk_parity +
+          5 * static_heuristic + 1 * mobility) /
+         (6 + 5 + 1 + 5 + 1);
+}
+
+void heuristic_batch(Board const* boards, std::size_t count, Player player,
+                     double* values, double alpha, double beta) {
+  std::array<SquareSums, max_lanes> sums;
+
+  for (std::size_t start = 0; start < count; start += max_lanes) {
+    std::size_t const size = std::min(max_lanes, count - start);
+    square_sums_batch(boards + start, size, sums.data());
+
+    for (std::size_t i = 0; i < size; i++) {
+      values[start + i] =
+          heuristic(boards[start + i], player, sums[i], alpha, beta);
+    }
+  }
+}
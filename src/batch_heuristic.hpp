@@ -0,0 +1,48 @@
+#ifndef REVERSI_BATCH_HEURISTIC_H_
+#define REVERSI_BATCH_HEURISTIC_H_
+
+#include <cstddef>
+#include <limits>
+#include "board.hpp"
+
+//! Static values of the squares, as used by the static heuristic.
+extern int const static_values[Board::size][Board::size];
+
+//! Sums over all squares of a board, which the cheap terms are made of.
+struct SquareSums {
+  int disk_diff;    // dark disks minus light disks
+  int disks;        // number of disks on the board
+  int dark_value;   // summed static values of the dark disks
+  int light_value;  // summed static values of the light disks
+};
+
+/*! Computes the square sums of a batch of boards.
+ *
+ * The boards are summed in groups of eight with AVX2 or four with SSE2, one
+ * board per vector lane, depending on what the CPU supports.  Elsewhere,
+ * they are summed one at a time.
+ */
+void square_sums_batch(Board const* boards, std::size_t count,
+                       SquareSums* sums);
+
+/*! Rates a board whose square sums are known.
+ *
+ * The result is identical to the one of heuristic(board, player, alpha,
+ * beta), but the move counts are computed only once.
+ */
+double heuristic(Board const& board, Player player, SquareSums const& sums,
+                 double alpha, double beta);
+
+/*! Rates a batch of boards.
+ *
+ * The square sums are computed a few boards at a time in buffers on the
+ * stack; the remaining terms are computed board by board.  Ratings which
+ * can not lie within the window (alpha, beta) are replaced by a bound, as by
+ * heuristic().
+ */
+void heuristic_batch(
+    Board const* boards, std::size_t count, Player player, double* values,
+    double alpha = -std::numeric_limits<double>::infinity(),
+    double beta = std::numeric_limits<double>::infinity());
+
+#endif
@@ -0,0 +1,335 @@
+#include "endgame.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+double disk_parity(Board const& board, Player player);
+
+namespace {
+
+//! Minimum number of empty squares for a node to be split between threads.
+std::size_t constexpr split_min_empties = 7;
+
+//! Number of nodes searched between two checks of the deadline.
+std::size_t constexpr nodes_per_deadline_check = 1024;
+
+double constexpr infinity = std::numeric_limits<double>::infinity();
+
+/*! Determines the next boards, with the least mobile replies first.
+ *
+ * Boards leaving the opponent few moves tend to be good, so searching them
+ * first results in more cut offs.
+ */
+std::vector<std::pair<Move, Board>> ordered_next_boards(Board const& board,
+                                                        Player player) {
+  Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+
+  std::vector<std::pair<std::size_t, std::pair<Move, Board>>> ordered;
+  for (auto const& next : board.next_boards(player)) {
+    ordered.push_back({next.second.legal_moves(opponent).size(), next});
+  }
+  std::stable_sort(ordered.begin(), ordered.end(),
+                   [](decltype(ordered)::value_type const& lhs,
+                      decltype(ordered)::value_type const& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+
+  std::vector<std::pair<Move, Board>> next_boards;
+  for (auto const& next : ordered) {
+    next_boards.push_back(next.second);
+  }
+  return next_boards;
+}
+
+class EndgameSolver {
+ public:
+  EndgameSolver(std::size_t threads,
+                std::chrono::steady_clock::time_point deadline);
+
+  boost::optional<EndgameSolution> solve(Board const& board, Player player);
+
+ private:
+  /*! A node whose younger children are searched in parallel.
+   *
+   * All members but parent and player are guarded by the mutex.
+   */
+  struct SplitPoint {
+    SplitPoint const* parent;
+    Player player;
+
+    std::mutex mutex;
+    double alpha;
+    double beta;
+    double best_value;
+
+    //! Number of children not searched yet.
+    std::size_t pending;
+
+    //! Set if the remaining children need not be searched any more.
+    std::atomic<bool> cut_off{false};
+  };
+
+  //! Search of a child of a split point.
+  struct Task {
+    SplitPoint* split;
+    Board board;
+  };
+
+  //! Work of a single thread.
+  struct Worker {
+    std::mutex mutex;
+
+    //! The owner works on the back, other threads steal from the front.
+    std::deque<Task> tasks;
+
+    std::size_t nodes = 0;
+  };
+
+  double search(std::size_t worker, Board const& board, Player player,
+                double alpha, double beta, SplitPoint* parent);
+  double search_move(std::size_t worker, Board const& next_board,
+                     Player player, double alpha, double beta,
+                     SplitPoint* parent);
+
+  //! Searches a task of the own deque or one stolen from another thread.
+  bool run_task(std::size_t worker);
+
+  //! Checks if the search below a split point is to be abandoned.
+  bool stopped(SplitPoint const* split) const;
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::chrono::steady_clock::time_point _deadline;
+
+  //! Set when the deadline has passed.
+  std::atomic<bool> _timed_out{false};
+};
+
+EndgameSolver::EndgameSolver(std::size_t threads,
+                             std::chrono::steady_clock::time_point deadline)
+    : _deadline(deadline) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(threads, 1); i++) {
+    _workers.emplace_back(new Worker);
+  }
+}
+
+boost::optional<EndgameSolution> EndgameSolver::solve(Board const& board,
+                                                      Player player) {
+  std::atomic<bool> done(false);
+
+  // the calling thread is the first worker; the others help it
+  std::vector<std::thread> helpers;
+  for (std::size_t i = 1; i < _workers.size(); i++) {
+    helpers.emplace_back([this, i, &done]() {
+      while (!done) {
+        if (!run_task(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // the moves at the root are searched one after another, in the same
+  // mobility order as everywhere else, and a move only replaces the best one
+  // if it is strictly better; so ties go to the first of the best moves in
+  // that order, for any number of threads
+  boost::optional<EndgameSolution> solution;
+  double alpha = -infinity;
+  for (auto const& next : ordered_next_boards(board, player)) {
+    double value = search_move(0, next.second, player, alpha, infinity,
+                               nullptr);
+    if (_timed_out) {
+      break;
+    }
+
+    if (value > alpha) {
+      alpha = value;
+      solution = EndgameSolution{next.first, value};
+    }
+  }
+
+  done = true;
+  for (auto& helper : helpers) {
+    helper.join();
+  }
+
+  if (_timed_out) {
+    return boost::none;
+  }
+  return solution;
+}
+
+//! Calculates the value of a move for the player who made it.
+double EndgameSolver::search_move(std::size_t worker, Board const& next_board,
+                                  Player player, double alpha, double beta,
+                                  SplitPoint* parent) {
+  Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+
+  if (!next_board.legal_moves(opponent).empty()) {
+    return -search(worker, next_board, opponent, -beta, -alpha, parent);
+  } else if (!next_board.legal_moves(player).empty()) {
+    // the opponent has to pass
+    return search(worker, next_board, player, alpha, beta, parent);
+  } else {
+    return disk_parity(next_board, player);
+  }
+}
+
+/*! Calculates the exact value of a board, if it lies within the window.
+ *
+ * Otherwise, a bound outside of the window is returned.  The player has to
+ * have a legal move.
+ */
+double EndgameSolver::search(std::size_t worker, Board const& board,
+                             Player player, double alpha, double beta,
+                             SplitPoint* parent) {
+  Worker& self = *_workers[worker];
+  if (++self.nodes % nodes_per_deadline_check == 0 &&
+      std::chrono::steady_clock::now() > _deadline) {
+    _timed_out = true;
+  }
+  if (stopped(parent)) {
+    // the result will be discarded
+    return 0;
+  }
+
+  auto next_boards = ordered_next_boards(board, player);
+
+  // young brothers wait: the eldest child is always searched first
+  double best_value =
+      search_move(worker, next_boards[0].second, player, alpha, beta, parent);
+  alpha = std::max(alpha, best_value);
+
+  std::size_t const empties = board.size * board.size - board.disk_no();
+  if (_workers.size() == 1 || empties < split_min_empties) {
+    for (std::size_t i = 1; i < next_boards.size() && alpha < beta; i++) {
+      double value = search_move(worker, next_boards[i].second, player, alpha,
+                                 beta, parent);
+      best_value = std::max(best_value, value);
+      alpha = std::max(alpha, value);
+    }
+
+    return best_value;
+  }
+
+  if (alpha >= beta || next_boards.size() == 1 || stopped(parent)) {
+    return best_value;
+  }
+
+  // offer the younger brothers to the other threads
+  SplitPoint split;
+  split.parent = parent;
+  split.player = player;
+  split.alpha = alpha;
+  split.beta = beta;
+  split.best_value = best_value;
+  split.pending = next_boards.size() - 1;
+
+  {
+    std::lock_guard<std::mutex> lock(self.mutex);
+    // the owner takes tasks from the back, so push the eldest last
+    for (std::size_t i = next_boards.size() - 1; i > 0; i--) {
+      self.tasks.push_back({&split, next_boards[i].second});
+    }
+  }
+
+  // help out until all children have been searched, as the split point is
+  // referenced by their tasks
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(split.mutex);
+      if (split.pending == 0) {
+        return split.best_value;
+      }
+    }
+
+    if (!run_task(worker)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool EndgameSolver::run_task(std::size_t worker) {
+  Task task;
+  bool found = false;
+
+  // own tasks first, newest first
+  {
+    Worker& self = *_workers[worker];
+    std::lock_guard<std::mutex> lock(self.mutex);
+    if (!self.tasks.empty()) {
+      task = self.tasks.back();
+      self.tasks.pop_back();
+      found = true;
+    }
+  }
+
+  // otherwise, steal the oldest task of another thread
+  for (std::size_t i = 1; !found && i < _workers.size(); i++) {
+    Worker& victim = *_workers[(worker + i) % _workers.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.front();
+      victim.tasks.pop_front();
+      found = true;
+    }
+  }
+
+  if (!found) {
+    return false;
+  }
+
+  SplitPoint& split = *task.split;
+
+  double alpha;
+  double beta;
+  {
+    std::lock_guard<std::mutex> lock(split.mutex);
+    alpha = split.alpha;
+    beta = split.beta;
+  }
+
+  double value = 0;
+  if (!stopped(&split)) {
+    value = search_move(worker, task.board, split.player, alpha, beta, &split);
+  }
+
+  std::lock_guard<std::mutex> lock(split.mutex);
+  // results of abandoned searches are meaningless
+  if (!stopped(&split)) {
+    split.best_value = std::max(split.best_value, value);
+    split.alpha = std::max(split.alpha, value);
+    if (split.alpha >= split.beta) {
+      split.cut_off = true;
+    }
+  }
+  split.pending--;
+
+  return true;
+}
+
+bool EndgameSolver::stopped(SplitPoint const* split) const {
+  if (_timed_out) {
+    return true;
+  }
+
+  for (; split; split = split->parent) {
+    if (split->cut_off) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
+boost::optional<EndgameSolution> solve_endgame(
+    Board const& board, Player player,
+    std::chrono::steady_clock::time_point deadline, std::size_t threads) {
+  return EndgameSolver(threads, deadline).solve(board, player);
+}
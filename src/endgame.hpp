@@ -0,0 +1,37 @@
+#ifndef REVERSI_ENDGAME_H_
+#define REVERSI_ENDGAME_H_
+
+#include <chrono>
+#include <cstddef>
+#include <boost/optional.hpp>
+#include "board.hpp"
+
+//! Result of solving a position.
+struct EndgameSolution {
+  /*! The first of the best moves.
+   *
+   * Moves are ordered by the number of replies they leave the opponent,
+   * fewest first, so ties may be broken differently than by minimax_actor.
+   */
+  Move best_move;
+
+  //! Final disk parity after perfect play, from the player's point of view.
+  double value;
+};
+
+/*! Solves a position exactly.
+ *
+ * The game tree is searched to its end using the given number of threads.
+ * Below the root, a node's children are searched in parallel after its
+ * eldest child has been searched (young brothers wait); every thread takes
+ * work from its own deque and steals from the others when it runs dry.
+ *
+ * The result does not depend on the number of threads.  If the deadline
+ * passes before the position is solved, none is returned.  So is it if the
+ * player has no legal move.
+ */
+boost::optional<EndgameSolution> solve_endgame(
+    Board const& board, Player player,
+    std::chrono::steady_clock::time_point deadline, std::size_t threads = 1);
+
+#endif
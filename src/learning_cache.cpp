@@ -0,0 +1,371 @@
+#include "learning_cache.hpp"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+struct LearningCache::Header {
+  std::uint64_t magic;
+
+  //! Format version; has to change whenever the heuristic changes.
+  std::uint64_t version;
+
+  std::uint64_t bucket_count;
+
+  //! Number of processes which opened the store so far.
+  std::atomic<std::uint64_t> generation;
+};
+
+/*! A single entry.
+ *
+ * check holds the hash of the position xor'ed with the other two words.
+ */
+struct LearningCache::Slot {
+  std::atomic<std::uint64_t> check;
+  std::atomic<std::uint64_t> value;
+  std::atomic<std::uint64_t> meta;
+};
+
+namespace {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "entries shared between processes need lock-free atomics");
+
+std::uint64_t constexpr magic = 0x4548434143495652;  // "RVICACHE"
+std::uint64_t constexpr version = 1;
+
+//! Number of slots per bucket.
+std::size_t constexpr bucket_size = 4;
+
+// layout of the meta word of a slot
+std::uint64_t constexpr used_bit = std::uint64_t(1) << 32;
+unsigned constexpr bound_shift = 8;
+unsigned constexpr move_shift = 16;
+unsigned constexpr generation_shift = 24;
+std::uint64_t constexpr no_move = 0xff;
+
+//! Number of orientations of a board (four rotations, each mirrored).
+unsigned constexpr symmetries = 8;
+
+//! Maps a square to its position in the given orientation.
+Move transform(unsigned symmetry, Move move) {
+  std::size_t x = move.first;
+  std::size_t y = move.second;
+
+  if (symmetry & 4) {
+    std::swap(x, y);
+  }
+  if (symmetry & 1) {
+    x = Board::size - 1 - x;
+  }
+  if (symmetry & 2) {
+    y = Board::size - 1 - y;
+  }
+
+  return {x, y};
+}
+
+//! Maps a square of the given orientation back to its original position.
+Move inverse_transform(unsigned symmetry, Move move) {
+  std::size_t x = move.first;
+  std::size_t y = move.second;
+
+  if (symmetry & 2) {
+    y = Board::size - 1 - y;
+  }
+  if (symmetry & 1) {
+    x = Board::size - 1 - x;
+  }
+  if (symmetry & 4) {
+    std::swap(x, y);
+  }
+
+  return {x, y};
+}
+
+/*! Random keys for Zobrist hashing.
+ *
+ * The keys are generated from a fixed seed, as they have to be the same for
+ * every process using a store.
+ */
+struct ZobristKeys {
+  std::uint64_t squares[Board::size * Board::size][2];
+  std::uint64_t light_to_move;
+
+  ZobristKeys() {
+    // splitmix64
+    std::uint64_t state = 0x2545f4914f6cdd1d;
+    auto next = [&state]() {
+      std::uint64_t z = (state += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      return z ^ (z >> 31);
+    };
+
+    for (auto& square : squares) {
+      square[0] = next();
+      square[1] = next();
+    }
+    light_to_move = next();
+  }
+};
+
+/*! Hashes the canonical orientation of a position.
+ *
+ * The canonical orientation is the one with the lowest hash; it is stored in
+ * symmetry.
+ */
+std::uint64_t canonical_hash(Board const& board, Player player,
+                             unsigned& symmetry) {
+  static ZobristKeys const keys;
+
+  std::uint64_t hashes[symmetries];
+  for (auto& hash : hashes) {
+    hash = (player == Player::light) ? keys.light_to_move : 0;
+  }
+
+  for (std::size_t x = 0; x < board.size; x++) {
+    for (std::size_t y = 0; y < board.size; y++) {
+      if (board[x][y] == Disk::none) {
+        continue;
+      }
+
+      std::size_t color = (board[x][y] == Disk::dark) ? 0 : 1;
+      for (unsigned s = 0; s < symmetries; s++) {
+        Move square = transform(s, {x, y});
+        hashes[s] ^= keys.squares[square.first * board.size + square.second]
+                                 [color];
+      }
+    }
+  }
+
+  symmetry = 0;
+  for (unsigned s = 1; s < symmetries; s++) {
+    if (hashes[s] < hashes[symmetry]) {
+      symmetry = s;
+    }
+  }
+
+  return hashes[symmetry];
+}
+
+//! Offset of the first slot in the file.
+std::size_t constexpr slots_offset = 64;
+
+std::size_t file_size(std::uint64_t bucket_count) {
+  return slots_offset + bucket_count * bucket_size * 3 * sizeof(std::uint64_t);
+}
+
+}  // namespace
+
+LearningCache::LearningCache(std::string const& path, std::size_t entries) {
+  static_assert(sizeof(Header) <= slots_offset, "header overlaps slots");
+  static_assert(sizeof(Slot) == 3 * sizeof(std::uint64_t),
+                "unexpected slot layout");
+
+  // descriptors to close before leaving the constructor
+  std::vector<int> fds;
+  auto fail = [&fds, &path]() {
+    int error = errno;
+    for (int descriptor : fds) {
+      close(descriptor);
+    }
+    throw std::system_error(error, std::generic_category(), path);
+  };
+
+  struct stat status;
+  while (true) {
+    int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      fail();
+    }
+    fds.push_back(fd);
+
+    // keep other processes from (re-)initializing the store at the same time
+    if (flock(fd, LOCK_EX) != 0 || fstat(fd, &status) != 0) {
+      fail();
+    }
+
+    // the file may have been replaced while waiting for the lock
+    struct stat current;
+    if (stat(path.c_str(), &current) == 0 && current.st_dev == status.st_dev &&
+        current.st_ino == status.st_ino) {
+      break;
+    }
+    close(fd);
+    fds.pop_back();
+  }
+  int fd = fds.back();
+
+  // check if the file holds a valid store
+  Header header = {};
+  bool valid = false;
+  if (static_cast<std::size_t>(status.st_size) >= sizeof(Header) &&
+      pread(fd, &header, sizeof(Header), 0) ==
+          static_cast<ssize_t>(sizeof(Header))) {
+    valid = header.magic == magic && header.version == version &&
+            header.bucket_count > 0 &&
+            static_cast<std::size_t>(status.st_size) ==
+                file_size(header.bucket_count);
+  }
+
+  std::uint64_t bucket_count =
+      valid ? header.bucket_count
+            : std::max<std::uint64_t>(1, (entries + bucket_size - 1) /
+                                             bucket_size);
+  _mapping_size = file_size(bucket_count);
+
+  if (!valid) {
+    // other processes may still have the old file mapped and would crash if
+    // it shrank, so the new store gets a file of its own, which replaces the
+    // old one once it is set up
+    std::string temporary_path = path + ".XXXXXX";
+    fd = mkstemp(&temporary_path[0]);
+    if (fd < 0) {
+      fail();
+    }
+    fds.push_back(fd);
+
+    if (flock(fd, LOCK_EX) != 0 || fchmod(fd, 0644) != 0 ||
+        ftruncate(fd, _mapping_size) != 0 ||
+        rename(temporary_path.c_str(), path.c_str()) != 0) {
+      int error = errno;
+      unlink(temporary_path.c_str());
+      errno = error;
+      fail();
+    }
+  }
+
+  _mapping = mmap(nullptr, _mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                  fd, 0);
+  if (_mapping == MAP_FAILED) {
+    fail();
+  }
+
+  _header = static_cast<Header*>(_mapping);
+  _slots = reinterpret_cast<Slot*>(static_cast<char*>(_mapping) +
+                                   slots_offset);
+
+  if (!valid) {
+    _header->version = version;
+    _header->bucket_count = bucket_count;
+    _header->generation = 0;
+    _header->magic = magic;
+  }
+  _generation = static_cast<std::uint8_t>(++_header->generation);
+
+  // the mapping stays valid after the files are closed; it keeps the locks
+  // held though, unless they are released explicitly
+  for (int descriptor : fds) {
+    flock(descriptor, LOCK_UN);
+    close(descriptor);
+  }
+}
+
+LearningCache::~LearningCache() { munmap(_mapping, _mapping_size); }
+
+LearningCache::Slot* LearningCache::bucket(std::uint64_t hash) const {
+  return _slots + (hash % _header->bucket_count) * bucket_size;
+}
+
+boost::optional<LearningCache::Entry> LearningCache::probe(
+    Board const& board, Player player) const {
+  unsigned symmetry;
+  std::uint64_t hash = canonical_hash(board, player, symmetry);
+
+  Slot* slots = bucket(hash);
+  for (std::size_t i = 0; i < bucket_size; i++) {
+    std::uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+    std::uint64_t value = slots[i].value.load(std::memory_order_relaxed);
+    std::uint64_t meta = slots[i].meta.load(std::memory_order_relaxed);
+
+    if (!(meta & used_bit) || (check ^ value ^ meta) != hash) {
+      // empty, torn or belonging to another position
+      continue;
+    }
+
+    Entry entry;
+    entry.depth = meta & 0xff;
+    std::memcpy(&entry.value, &value, sizeof(value));
+    entry.bound = static_cast<Bound>((meta >> bound_shift) & 0xff);
+
+    std::uint64_t move = (meta >> move_shift) & 0xff;
+    if (move != no_move) {
+      entry.best_move = inverse_transform(
+          symmetry, {move / board.size, move % board.size});
+    }
+
+    return entry;
+  }
+
+  return boost::none;
+}
+
+void LearningCache::store(Board const& board, Player player,
+                          Entry const& entry) {
+  unsigned symmetry;
+  std::uint64_t hash = canonical_hash(board, player, symmetry);
+
+  // pick the slot holding the position or the least valuable one
+  Slot* slots = bucket(hash);
+  Slot* victim = nullptr;
+  int victim_priority = std::numeric_limits<int>::max();
+  for (std::size_t i = 0; i < bucket_size; i++) {
+    std::uint64_t check = slots[i].check.load(std::memory_order_relaxed);
+    std::uint64_t value = slots[i].value.load(std::memory_order_relaxed);
+    std::uint64_t meta = slots[i].meta.load(std::memory_order_relaxed);
+
+    if (!(meta & used_bit)) {
+      victim = &slots[i];
+      victim_priority = std::numeric_limits<int>::min();
+      continue;
+    }
+
+    int depth = meta & 0xff;
+    if ((check ^ value ^ meta) == hash) {
+      if (static_cast<std::size_t>(depth) > entry.depth) {
+        // keep the deeper result
+        return;
+      }
+      victim = &slots[i];
+      break;
+    }
+
+    // entries written by earlier processes age out
+    int age =
+        static_cast<std::uint8_t>(_generation - (meta >> generation_shift));
+    int priority = depth - 2 * age;
+    if (priority < victim_priority) {
+      victim = &slots[i];
+      victim_priority = priority;
+    }
+  }
+
+  std::uint64_t move = no_move;
+  if (entry.best_move) {
+    Move canonical = transform(symmetry, *entry.best_move);
+    move = canonical.first * board.size + canonical.second;
+  }
+
+  std::uint64_t value;
+  std::memcpy(&value, &entry.value, sizeof(value));
+  std::uint64_t meta =
+      used_bit | (std::uint64_t(_generation) << generation_shift) |
+      (move << move_shift) |
+      (std::uint64_t(static_cast<std::uint8_t>(entry.bound)) << bound_shift) |
+      std::min<std::size_t>(entry.depth, 0xff);
+
+  victim->value.store(value, std::memory_order_relaxed);
+  victim->meta.store(meta, std::memory_order_relaxed);
+  victim->check.store(hash ^ value ^ meta, std::memory_order_relaxed);
+}
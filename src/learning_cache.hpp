@@ -0,0 +1,76 @@
+#ifndef REVERSI_LEARNING_CACHE_H_
+#define REVERSI_LEARNING_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <boost/optional.hpp>
+#include "board.hpp"
+
+/*! Persistent store of search results.
+ *
+ * The store is a file of fixed size which is memory-mapped by every process
+ * using it, so results of earlier games are available to later ones.
+ * Positions are stored under the hash of their canonical orientation, so
+ * rotated and mirrored positions share their entries.
+ *
+ * Entries are written without locks.  Each entry holds its key xor'ed with
+ * its contents, so entries torn by concurrent writers are not found again.
+ * When a bucket is full, the shallowest and oldest entry is evicted.
+ */
+class LearningCache {
+ public:
+  //! How the stored value relates to the real value of a position.
+  enum class Bound : std::uint8_t { exact, lower, upper };
+
+  //! A search result.
+  struct Entry {
+    //! Depth the position was searched to.
+    std::size_t depth;
+
+    double value;
+    Bound bound;
+
+    //! Best move found, if any.
+    boost::optional<Move> best_move;
+  };
+
+  /*! Opens the store at the given path.
+   *
+   * If the file does not exist or is no valid store, a new store with room
+   * for the given number of entries is created.  It takes the place of the
+   * old file, which processes still using it keep intact.
+   *
+   * \throws std::system_error if the file can not be opened or mapped.
+   */
+  explicit LearningCache(std::string const& path,
+                         std::size_t entries = 1 << 20);
+  ~LearningCache();
+
+  LearningCache(LearningCache const&) = delete;
+  LearningCache& operator=(LearningCache const&) = delete;
+
+  //! Looks up the result for a position.
+  boost::optional<Entry> probe(Board const& board, Player player) const;
+
+  //! Stores the result for a position.
+  void store(Board const& board, Player player, Entry const& entry);
+
+ private:
+  struct Header;
+  struct Slot;
+
+  //! Pointer to the first slot of the bucket holding a hash.
+  Slot* bucket(std::uint64_t hash) const;
+
+  void* _mapping;
+  std::size_t _mapping_size;
+
+  Header* _header;
+  Slot* _slots;
+
+  //! Generation of this process, used to age out entries.
+  std::uint8_t _generation;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "libreversi.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "batch_heuristic.hpp"
+#include "board.hpp"
+#include "minimax.hpp"
+
+static_assert(REVERSI_SIZE == Board::size, "board sizes differ");
+
+namespace {
+
+//! Number of boards converted at once by reversi_evaluate.
+std::size_t constexpr evaluation_chunk = 16;
+
+Board to_board(reversi_board const& board) {
+  Board result;
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y++) {
+      result[x][y] = static_cast<Disk>(board.squares[x * Board::size + y]);
+    }
+  }
+  return result;
+}
+
+reversi_board from_board(Board const& board) {
+  reversi_board result;
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y++) {
+      result.squares[x * Board::size + y] = board[x][y];
+    }
+  }
+  return result;
+}
+
+Move to_move(uint8_t move) {
+  return {move / Board::size, move % Board::size};
+}
+
+uint8_t from_move(Move move) {
+  return move.first * Board::size + move.second;
+}
+
+bool valid_player(int player) {
+  return player == REVERSI_DARK || player == REVERSI_LIGHT;
+}
+
+}  // namespace
+
+int reversi_abi_version(void) { return REVERSI_ABI_VERSION; }
+
+void reversi_board_init(reversi_board* board) { *board = from_board(Board()); }
+
+size_t reversi_legal_moves(reversi_board const* board, int player,
+                           uint8_t* moves) {
+  if (!valid_player(player)) {
+    return 0;
+  }
+
+  Board const b = to_board(*board);
+  std::size_t count = 0;
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y++) {
+      if (b.legal_move({x, y}, static_cast<Player>(player))) {
+        moves[count++] = from_move({x, y});
+      }
+    }
+  }
+
+  return count;
+}
+
+int reversi_play(reversi_board const* board, int player, uint8_t move,
+                 reversi_board* next) {
+  if (!valid_player(player) || move >= REVERSI_SQUARES) {
+    return 0;
+  }
+
+  if (auto next_board = to_board(*board).next_board(
+          to_move(move), static_cast<Player>(player))) {
+    *next = from_board(*next_board);
+    return 1;
+  }
+
+  return 0;
+}
+
+int reversi_game_over(reversi_board const* board) {
+  return to_board(*board).game_over() ? 1 : 0;
+}
+
+int reversi_evaluate(reversi_board const* boards, size_t count, int player,
+                     double* values) {
+  if (!valid_player(player)) {
+    return 0;
+  }
+
+  std::array<Board, evaluation_chunk> chunk;
+  std::array<SquareSums, evaluation_chunk> sums;
+  double constexpr infinity = std::numeric_limits<double>::infinity();
+
+  // no exceptions may pass the C interface
+  try {
+    for (std::size_t start = 0; start < count; start += evaluation_chunk) {
+      std::size_t size = std::min(evaluation_chunk, count - start);
+      for (std::size_t i = 0; i < size; i++) {
+        chunk[i] = to_board(boards[start + i]);
+      }
+
+      square_sums_batch(chunk.data(), size, sums.data());
+      for (std::size_t i = 0; i < size; i++) {
+        values[start + i] = heuristic(chunk[i], static_cast<Player>(player),
+                                      sums[i], -infinity, infinity);
+      }
+    }
+  } catch (...) {
+    return 0;
+  }
+
+  return 1;
+}
+
+int reversi_search(reversi_board const* board, int player,
+                   reversi_search_limits const* limits, size_t k,
+                   reversi_search_result* results) {
+  if (!board || !limits || !results || !valid_player(player) ||
+      !(limits->seconds >= 0)) {
+    // the last check also rejects NaN
+    return -1;
+  }
+
+  // no exceptions may pass the C interface
+  try {
+    // converting longer times than the clock can represent would overflow
+    std::chrono::duration<double> const seconds(limits->seconds);
+    auto time_limit = std::chrono::steady_clock::duration::max();
+    if (seconds < time_limit) {
+      time_limit =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              seconds);
+    }
+    std::size_t max_depth =
+        limits->depth ? limits->depth : Board::size * Board::size;
+
+    auto ranking = minimax_analysis(to_board(*board),
+                                    static_cast<Player>(player), k,
+                                    time_limit, max_depth);
+
+    for (std::size_t i = 0; i < ranking.size(); i++) {
+      MoveAnalysis const& analysis = ranking[i];
+      reversi_search_result& result = results[i];
+
+      result.move = from_move(analysis.move);
+      result.value = analysis.value;
+      result.principal_variation_length = analysis.principal_variation.size();
+      std::transform(analysis.principal_variation.begin(),
+                     analysis.principal_variation.end(),
+                     result.principal_variation, from_move);
+    }
+
+    return ranking.size();
+  } catch (...) {
+    return -1;
+  }
+}
@@ -0,0 +1,126 @@
+#ifndef REVERSI_LIBREVERSI_H_
+#define REVERSI_LIBREVERSI_H_
+
+/* C interface of the reversi library.
+ *
+ * All functions work on buffers owned by the caller.  Squares and moves are
+ * numbered x * REVERSI_SIZE + y, where x is the column and y the row of the
+ * square.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Marks the functions exported by the shared library; all other symbols of
+ * the library are hidden.
+ */
+#if defined(__GNUC__)
+#define REVERSI_API __attribute__((visibility("default")))
+#else
+#define REVERSI_API
+#endif
+
+/* Version of the interface; changes whenever a declaration below changes. */
+#define REVERSI_ABI_VERSION 2
+
+/* Length of the board. */
+#define REVERSI_SIZE 8
+
+/* Number of squares on the board. */
+#define REVERSI_SQUARES (REVERSI_SIZE * REVERSI_SIZE)
+
+/* Contents of a square; the players are identified by their disks. */
+#define REVERSI_NONE 0
+#define REVERSI_DARK 1
+#define REVERSI_LIGHT (-1)
+
+typedef struct reversi_board {
+  int8_t squares[REVERSI_SQUARES];
+} reversi_board;
+
+/* Bounds of a search; the search ends as soon as either is reached.
+ *
+ * The first iteration of a search is always completed.  After that, the time
+ * limit is checked every thousand or so positions searched, and an iteration
+ * still running when it has passed is abandoned.
+ */
+typedef struct reversi_search_limits {
+  /* Maximum time in seconds, or INFINITY for no limit.
+   *
+   * Times too long for the clock of the library, which covers at least a
+   * century, also mean no limit.  Negative times and NaN are rejected.
+   */
+  double seconds;
+
+  /* Maximum depth in moves, or 0 for no limit. */
+  uint32_t depth;
+} reversi_search_limits;
+
+typedef struct reversi_search_result {
+  uint8_t move;
+
+  /* Value of the move in the interval [-1, 1]. */
+  double value;
+
+  /* Expected line of play, starting with the move itself.
+   *
+   * If the process uses a learning cache, the line may be shorter than the
+   * search depth, as the cache only keeps the first move of a line.
+   */
+  uint8_t principal_variation[REVERSI_SQUARES];
+  uint32_t principal_variation_length;
+} reversi_search_result;
+
+/* Returns REVERSI_ABI_VERSION of the library. */
+REVERSI_API int reversi_abi_version(void);
+
+/* Sets up the initial position. */
+REVERSI_API void reversi_board_init(reversi_board* board);
+
+/* Determines all legal moves of a player.
+ *
+ * moves needs room for REVERSI_SQUARES moves.  Returns the number of moves.
+ */
+REVERSI_API size_t reversi_legal_moves(reversi_board const* board,
+                                       int player, uint8_t* moves);
+
+/* Applies a move to a board.
+ *
+ * Returns 1 and stores the resulting board in next if the move is legal,
+ * otherwise returns 0 and leaves next untouched.
+ */
+REVERSI_API int reversi_play(reversi_board const* board, int player,
+                             uint8_t move, reversi_board* next);
+
+/* Returns 1 if no player can move any more, otherwise 0. */
+REVERSI_API int reversi_game_over(reversi_board const* board);
+
+/* Rates count boards from the view of a player.
+ *
+ * Returns 1 and sets values[i] to the rating of boards[i], in the interval
+ * [-1, 1], if the player is valid.  Returns 0 and leaves values untouched if
+ * it is not, or 0 with values partially set if the library runs out of
+ * memory.
+ */
+REVERSI_API int reversi_evaluate(reversi_board const* boards, size_t count,
+                                 int player, double* values);
+
+/* Determines the k best moves of a player, best first.
+ *
+ * results needs room for k results.  Returns the number of results, which is
+ * less than k if there are fewer legal moves, or -1 on failure or invalid
+ * arguments.
+ */
+REVERSI_API int reversi_search(reversi_board const* board, int player,
+                               reversi_search_limits const* limits, size_t k,
+                               reversi_search_result* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,4 +1,39 @@
+#include <iostream>
+#include <memory>
+#include <system_error>
+#include "learning_cache.hpp"
 #include "minimax.hpp"
 #include "reversi.hpp"
 
-int main() { play_reversi(minimax_actor, minimax_actor, true); }
+/*! Plays a game of reversi.
+ *
+ * Usage: reversi [learning-cache]
+ *
+ * If a path is given, search results are kept in a store at this path and
+ * reused by later games.  If the store can not be opened, the program
+ * exits with status 1.
+ */
+int main(int argc, char** argv) {
+  std::unique_ptr<LearningCache> learning_cache;
+  if (argc > 1) {
+    try {
+      learning_cache.reset(new LearningCache(argv[1]));
+    } catch (std::system_error const& error) {
+      // the message names the path and the reason
+      std::cerr << argv[0] << ": cannot open learning cache " << error.what()
+                << std::endl;
+      return 1;
+    }
+    set_learning_cache(learning_cache.get());
+  }
+
+  // each player gets 15 minutes, plus 10 seconds per move
+  GameClock const clock = {std::chrono::minutes(15), std::chrono::seconds(10)};
+  play_reversi(minimax_actor, minimax_actor, clock, true);
+
+#ifdef REVERSI_PROFILE_TERMS
+  for (size_t term = 0; term < term_count; term++) {
+    std::cout << term_names[term] << ": " << term_calls[term] << std::endl;
+  }
+#endif
+}
@@ -1,27 +1,182 @@
+#include <algorithm>
 #include <chrono>
+#include <limits>
+#include <new>
+#include <thread>
+#include <type_traits>
 #include <tuple>
+#include "batch_heuristic.hpp"
 #include "board.hpp"
+#include "endgame.hpp"
+#include "learning_cache.hpp"
+#include "minimax.hpp"
+#include "time_manager.hpp"
 #include <iostream>
 
+#ifdef REVERSI_PROFILE_TERMS
+char const* const term_names[term_count] = {
+    "heuristic",   "corners_captured", "stability", "semi_stable_disks",
+    "disk_parity", "static_heuristic", "mobility"};
+
+std::array<std::atomic<unsigned long long>, term_count> term_calls = {};
+#endif
+
+//! Store of search results shared between games, if any.
+static LearningCache* learning_cache = nullptr;
+
+//! Minimum search depth of results kept in the learning cache.
+static size_t constexpr learning_cache_depth = 4;
+
+//! Maximum number of empty squares for positions to be solved exactly.
+static size_t constexpr endgame_empties = 16;
+
+//! Number of nodes searched between two checks of the search deadline.
+static size_t constexpr nodes_per_deadline_check = 1024;
+
+//! Maximum number of moves in a position, one per empty square.
+static size_t constexpr max_moves = Board::size * Board::size - 4;
+
 // declarations
-double minimax_depth(Board const& board, Player player, size_t depth,
-                     double alpha, double beta);
+std::vector<MoveAnalysis> rank_moves(
+    SearchContext& context, Player player,
+    std::vector<std::pair<Move, Board>>& next_boards,
+    std::vector<MoveAnalysis> const& previous_ranking, size_t k,
+    size_t depth);
+double minimax_depth(SearchContext& context, Board const& board,
+                     Player player, size_t depth, double alpha, double beta,
+                     std::vector<Move>* principal_variation = nullptr);
+double minimax_move(SearchContext& context, Board const& next_board,
+                    Player player, size_t depth, double alpha, double beta,
+                    std::vector<Move>* principal_variation = nullptr);
 double heuristic(Board const& board, Player player);
+double heuristic(Board const& board, Player player, double alpha, double beta);
+boost::optional<double> rating_bound(double partial, double remaining_weight,
+                                     double alpha, double beta);
 double corners_captured(Board const& board, Player player);
 double stability(Board const& board, Player player);
 double disk_parity(Board const& board, Player player);
 double static_heuristic(Board const& board, Player player);
 double mobility(Board const& board, Player player);
 
-//! Determine move using the minimax algorithm.
-Move minimax_actor(Board const& board, Player player) {
+void set_learning_cache(LearningCache* cache) { learning_cache = cache; }
+
+//! Counts a searched node, checking the deadline every so many nodes.
+static void count_node(SearchContext& context) {
+  if (++context.nodes % nodes_per_deadline_check == 0 &&
+      std::chrono::steady_clock::now() > context.deadline) {
+    context.aborted = true;
+  }
+}
+
+/*! Determine move using the minimax algorithm.
+ *
+ * The thinking time is allocated by a TimeManager from the player's clock.
+ */
+Move minimax_actor(Board const& board, Player player, GameClock const& clock) {
+  TimeManager time_manager(clock, board, player);
+
   // time when the computation started
   auto start_time = std::chrono::steady_clock::now();
-  // time when the computation needs to be finished
-  auto end_time = start_time + std::chrono::seconds(60);
+
+  auto next_boards = board.next_boards(player);
+  if (next_boards.size() == 1) {
+    // forced move
+    return next_boards[0].first;
+  }
 
   // best move found so far
-  Move best_move = {-1, -1};
+  Move best_move = next_boards[0].first;
+
+  size_t depth = 1;
+  size_t const max_remaining_moves = board.size * board.size - board.disk_no();
+
+  if (learning_cache) {
+    // the position may have been solved in an earlier game
+    auto entry = learning_cache->probe(board, player);
+    if (entry && entry->bound == LearningCache::Bound::exact &&
+        entry->depth >= max_remaining_moves && entry->best_move) {
+      return *entry->best_move;
+    }
+  }
+
+  if (max_remaining_moves <= endgame_empties) {
+    // solve the position exactly, falling back to iterative deepening if
+    // that takes too long
+    auto solution =
+        solve_endgame(board, player, time_manager.soft_deadline(),
+                      std::thread::hardware_concurrency());
+    if (solution) {
+      if (learning_cache) {
+        learning_cache->store(board, player,
+                              {max_remaining_moves, solution->value,
+                               LearningCache::Bound::exact,
+                               solution->best_move});
+      }
+
+      std::cout << "solved ";
+      return solution->best_move;
+    }
+  }
+
+  SearchContext context;
+  context.deadline = time_manager.hard_deadline();
+
+  // iterative deepening; the two best moves are ranked, so it can be told
+  // whether the best one is clearly better than the rest
+  std::vector<MoveAnalysis> ranking;
+  bool next_iteration = true;
+  while (next_iteration && depth <= max_remaining_moves) {
+    std::cout << depth << ' ';
+    std::cout.flush();
+    auto iteration_start_time = std::chrono::steady_clock::now();
+
+    auto iteration_ranking =
+        rank_moves(context, player, next_boards, ranking, 2, depth);
+    if (context.aborted) {
+      // the hard deadline passed; the iteration is incomplete
+      break;
+    }
+
+    ranking = iteration_ranking;
+    best_move = ranking[0].move;
+    double best_value = ranking[0].value;
+
+    if (learning_cache && depth >= learning_cache_depth) {
+      learning_cache->store(
+          board, player,
+          {depth, best_value, LearningCache::Bound::exact, best_move});
+    }
+
+    double margin = (ranking.size() > 1)
+                        ? best_value - ranking[1].value
+                        : std::numeric_limits<double>::infinity();
+    next_iteration = time_manager.next_iteration(
+        best_move, margin,
+        std::chrono::steady_clock::now() - iteration_start_time);
+    depth++;
+  }
+
+  std::cout << std::chrono::duration_cast<std::chrono::seconds>(
+                   std::chrono::steady_clock::now() - start_time)
+                   .count();
+  return best_move;
+}
+
+/*! Determines the k best moves using the minimax algorithm.
+ *
+ * Each iteration searches the moves ranked best by the previous iteration
+ * first.
+ */
+std::vector<MoveAnalysis> minimax_analysis(
+    Board const& board, Player player, size_t k,
+    std::chrono::steady_clock::duration time_limit, size_t max_depth,
+    unsigned long long* searched_nodes) {
+  auto start_time = std::chrono::steady_clock::now();
+  // time limits reaching past the end of the clock mean no limit
+  auto end_time =
+      time_limit < std::chrono::steady_clock::time_point::max() - start_time
+          ? start_time + time_limit
+          : std::chrono::steady_clock::time_point::max();
 
   // expected average branching factor
   double constexpr branch_fac = 8;
@@ -32,77 +187,217 @@ Move minimax_actor(Board const& board, Player player) {
   size_t depth = 1;
   size_t const max_remaining_moves = board.size * board.size - board.disk_no();
 
+  auto next_boards = board.next_boards(player);
+  std::vector<MoveAnalysis> ranking;
+  if (k == 0) {
+    return ranking;
+  }
+
+  SearchContext context;
+
   // iterative deepening
   while (depth == 1 || (end_time - std::chrono::steady_clock::now() >
                             branch_fac * last_it_duration &&
-                        depth <= max_remaining_moves)) {
-    std::cout << depth << ' ';
-    std::cout.flush();
+                        depth <= std::min(max_depth, max_remaining_moves))) {
     auto iteration_start_time = std::chrono::steady_clock::now();
 
-    // values for alpha-beta cutoff
-    double alpha = -1;
-    double beta = 1;
+    auto iteration_ranking =
+        rank_moves(context, player, next_boards, ranking, k, depth);
+    if (context.aborted) {
+      // the iteration is incomplete; keep the one before
+      break;
+    }
+    ranking = iteration_ranking;
 
-    double best_value = alpha;
+    // only the first iteration may run past the time limit
+    context.deadline = end_time;
 
-    // recursively do minimax search on all possible next boards
-    for (auto next : board.next_boards(player)) {
-      Move move;
-      Board next_board;
-      std::tie(move, next_board) = next;
+    depth++;
+    last_it_duration = std::chrono::steady_clock::now() - iteration_start_time;
+  }
 
-      Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+  if (searched_nodes) {
+    *searched_nodes = context.nodes;
+  }
+  return ranking;
+}
 
-      double value =
-          (!next_board.legal_moves(opponent).empty())
-              ? -minimax_depth(next_board, opponent, depth - 1, -beta, -alpha)
-              : minimax_depth(next_board, player, depth - 1, alpha, beta);
+/*! Ranks the k best moves, searching to the given depth.
+ *
+ * The next boards are reordered so that the moves of the previous ranking
+ * are searched first.  A move is searched with a window starting at the value
+ * of the k-th best move found so far, so that moves outside of the k best are
+ * refuted cheaply while the others get their exact value.
+ */
+std::vector<MoveAnalysis> rank_moves(
+    SearchContext& context, Player player,
+    std::vector<std::pair<Move, Board>>& next_boards,
+    std::vector<MoveAnalysis> const& previous_ranking, size_t k,
+    size_t depth) {
+  auto rank = [&previous_ranking](Move move) {
+    return std::find_if(
+               previous_ranking.begin(), previous_ranking.end(),
+               [move](MoveAnalysis const& a) { return a.move == move; }) -
+           previous_ranking.begin();
+  };
+  std::stable_sort(next_boards.begin(), next_boards.end(),
+                   [&rank](std::pair<Move, Board> const& lhs,
+                           std::pair<Move, Board> const& rhs) {
+                     return rank(lhs.first) < rank(rhs.first);
+                   });
+
+  std::vector<MoveAnalysis> ranking;
+  if (k == 0) {
+    return ranking;
+  }
 
-      if (value > best_value) {
-        best_value = value;
-        best_move = move;
-      }
+  for (auto const& next : next_boards) {
+    // only moves beating the current k-th best one need an exact value
+    double alpha = (ranking.size() < k)
+                       ? -std::numeric_limits<double>::infinity()
+                       : ranking.back().value;
+    double beta = std::numeric_limits<double>::infinity();
 
-      if (value > alpha) {
-        alpha = value;
+    std::vector<Move> continuation;
+    double value = minimax_move(context, next.second, player, depth - 1,
+                                alpha, beta, &continuation);
+
+    if (value > alpha) {
+      MoveAnalysis analysis = {next.first, value, {next.first}};
+      analysis.principal_variation.insert(analysis.principal_variation.end(),
+                                          continuation.begin(),
+                                          continuation.end());
+
+      auto position = std::find_if(
+          ranking.begin(), ranking.end(),
+          [value](MoveAnalysis const& a) { return a.value < value; });
+      ranking.insert(position, analysis);
+      if (ranking.size() > k) {
+        ranking.pop_back();
       }
     }
-
-    depth++;
-    last_it_duration = std::chrono::steady_clock::now() - iteration_start_time;
   }
 
-  std::cout << std::chrono::duration_cast<std::chrono::seconds>(
-                   std::chrono::steady_clock::now() - start_time)
-                   .count();
-  return best_move;
+  return ranking;
 }
 
-//! Calculates the maximum reachable value of a board configuration
-double minimax_depth(Board const& board, Player player, size_t depth,
-                     double alpha, double beta) {
+/*! Calculates the maximum reachable value of a board configuration
+ *
+ * If principal_variation is given, it is set to the best line of play found,
+ * as long as the value lies within the window.  Below a position whose
+ * result is taken from the learning cache, the line is cut off after the
+ * stored best move.
+ */
+double minimax_depth(SearchContext& context, Board const& board,
+                     Player player, size_t depth, double alpha, double beta,
+                     std::vector<Move>* principal_variation) {
+  if (principal_variation) {
+    principal_variation->clear();
+  }
+
+  count_node(context);
+  if (context.aborted) {
+    return 0;
+  }
+
+  bool const use_learning_cache =
+      learning_cache && depth >= learning_cache_depth;
+  if (use_learning_cache) {
+    // use the result of an earlier search, if it is deep enough
+    auto entry = learning_cache->probe(board, player);
+    if (entry && entry->depth >= depth &&
+        (entry->bound == LearningCache::Bound::exact ||
+         (entry->bound == LearningCache::Bound::lower &&
+          entry->value >= beta) ||
+         (entry->bound == LearningCache::Bound::upper &&
+          entry->value <= alpha))) {
+      // the rest of the line is not stored
+      if (principal_variation && entry->best_move) {
+        *principal_variation = {*entry->best_move};
+      }
+      return entry->value;
+    }
+  }
+
   if (depth == 0 || board.game_over()) {
     // maximum iteration depth or final board state reached
-    return heuristic(board, player);
+    return heuristic(board, player, alpha, beta);
   }
 
+  double const original_alpha = alpha;
   double best_value = alpha;
+  boost::optional<Move> best_move;
+
+  if (depth == 1) {
+    // all next boards are leaves; as the heuristic is symmetric, each of them
+    // can be rated from this player's point of view.  Their square sums are
+    // computed in one batch, the other terms leaf by leaf, so that no leaf
+    // after a cut off is rated.
+    //
+    // This is the hottest part of the search, so the leaves are kept on the
+    // stack.  Their storage is left uninitialized, as constructing a board
+    // sets up the initial position.
+    std::aligned_storage<sizeof(Board), alignof(Board)>::type
+        leaf_storage[max_moves];
+    Board* const leaves = reinterpret_cast<Board*>(leaf_storage);
+    Move leaf_moves[max_moves];
+    SquareSums sums[max_moves];
+
+    size_t leaf_count = 0;
+    for (size_t x = 0; x < board.size; x++) {
+      for (size_t y = 0; y < board.size; y++) {
+        if (auto next_board = board.next_board({x, y}, player)) {
+          new (&leaves[leaf_count]) Board(*next_board);
+          leaf_moves[leaf_count++] = {x, y};
+        }
+      }
+    }
+
+    square_sums_batch(leaves, leaf_count, sums);
+
+    for (size_t i = 0; i < leaf_count; i++) {
+      // the leaf is not searched by minimax_depth, but is a node all the same
+      count_node(context);
+      double value = heuristic(leaves[i], player, sums[i], alpha, beta);
+
+      if (value > best_value) {
+        best_value = value;
+        if (principal_variation) {
+          *principal_variation = {leaf_moves[i]};
+        }
+      }
+
+      if (value > alpha) {
+        alpha = value;
+      }
+
+      if (beta <= alpha) {
+        // beta cut off
+        break;
+      }
+    }
+
+    return best_value;
+  }
 
   for (auto next : board.next_boards(player)) {
     Move move;
     Board next_board;
     std::tie(move, next_board) = next;
 
-    Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
-
+    std::vector<Move> continuation;
     double value =
-        (!next_board.legal_moves(opponent).empty())
-            ? -minimax_depth(next_board, opponent, depth - 1, -beta, -alpha)
-            : minimax_depth(next_board, player, depth - 1, alpha, beta);
+        minimax_move(context, next_board, player, depth - 1, alpha, beta,
+                     principal_variation ? &continuation : nullptr);
 
     if (value > best_value) {
       best_value = value;
+      best_move = move;
+      if (principal_variation) {
+        *principal_variation = {move};
+        principal_variation->insert(principal_variation->end(),
+                                    continuation.begin(), continuation.end());
+      }
     }
 
     if (value > alpha) {
@@ -111,31 +406,112 @@ double minimax_depth(Board const& board, Player player, size_t depth,
 
     if (beta <= alpha) {
       // beta cut off
-      return best_value;
+      break;
     }
   }
 
+  if (use_learning_cache && !context.aborted) {
+    LearningCache::Entry entry = {depth, best_value,
+                                  LearningCache::Bound::exact, best_move};
+    if (best_value <= original_alpha) {
+      entry.bound = LearningCache::Bound::upper;
+    } else if (best_value >= beta) {
+      entry.bound = LearningCache::Bound::lower;
+    }
+    learning_cache->store(board, player, entry);
+  }
+
   return best_value;
 }
 
+/*! Calculates the value of a move for the player who made it.
+ *
+ * The opponent moves next, unless they have to pass.
+ */
+double minimax_move(SearchContext& context, Board const& next_board,
+                    Player player, size_t depth, double alpha, double beta,
+                    std::vector<Move>* principal_variation) {
+  Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+
+  return (!next_board.legal_moves(opponent).empty())
+             ? -minimax_depth(context, next_board, opponent, depth, -beta,
+                              -alpha, principal_variation)
+             : minimax_depth(context, next_board, player, depth, alpha, beta,
+                             principal_variation);
+}
+
 /*! Rates a board.
  *
  * \returnsa value in the interval [-1, 1], where -1 is the worst and 1 is the
  * best possible rating of the board for the player.
  */
 double heuristic(Board const& board, Player player) {
+  return heuristic(board, player, -std::numeric_limits<double>::infinity(),
+                   std::numeric_limits<double>::infinity());
+}
+
+/*! Rates a board, as far as it is needed for an alpha-beta search.
+ *
+ * The terms are computed cheapest first.  As soon as the rating can not end
+ * up within the window (alpha, beta) any more, a bound of it is returned
+ * instead: an upper bound <= alpha or a lower bound >= beta.
+ */
+double heuristic(Board const& board, Player player, double alpha,
+                 double beta) {
+  PROFILE_TERM(term_heuristic);
   if (board.disk_no() > board.size * board.size - 4 || board.game_over()) {
     return disk_parity(board, player);
-  } else {
-    return (6 * corners_captured(board, player) + 5 * stability(board, player) +
-            1 * disk_parity(board, player) +
-            5 * static_heuristic(board, player) + 1 * mobility(board, player)) /
-           (6 + 5 + 1 + 5 + 1);
   }
+
+  double const corners = corners_captured(board, player);
+  double const parity = disk_parity(board, player);
+  double const static_value = static_heuristic(board, player);
+  if (auto bound = rating_bound(6 * corners + 1 * parity + 5 * static_value,
+                                1 + 5, alpha, beta)) {
+    return *bound;
+  }
+
+  double const mobility_value = mobility(board, player);
+  if (auto bound = rating_bound(
+          6 * corners + 1 * parity + 5 * static_value + 1 * mobility_value, 5,
+          alpha, beta)) {
+    return *bound;
+  }
+
+  return (6 * corners + 5 * stability(board, player) + 1 * parity +
+          5 * static_value + 1 * mobility_value) /
+         (6 + 5 + 1 + 5 + 1);
+}
+
+/*! Checks if a partially computed rating can still end up within a window.
+ *
+ * partial is the weighted sum of the terms computed so far and
+ * remaining_weight the summed weight of the missing terms, each of which lies
+ * in [-1, 1].  If the rating is bound to lie outside of the window, the bound
+ * is returned.
+ */
+boost::optional<double> rating_bound(double partial, double remaining_weight,
+                                     double alpha, double beta) {
+  double constexpr weight_sum = 6 + 5 + 1 + 5 + 1;
+  // guards the bounds against rounding errors
+  double constexpr margin = 1e-9;
+
+  double const upper = (partial + remaining_weight) / weight_sum + margin;
+  if (upper <= alpha) {
+    return upper;
+  }
+
+  double const lower = (partial - remaining_weight) / weight_sum - margin;
+  if (lower >= beta) {
+    return lower;
+  }
+
+  return boost::none;
 }
 
 //! Calculates the relative amount of corners captured by a player.
 double corners_captured(Board const& board, Player player) {
+  PROFILE_TERM(term_corners_captured);
   using Pos = std::pair<size_t, size_t>;
   double corner_diff = 0;
   double corners_captured = 0;
@@ -166,6 +542,7 @@ double corners_captured(Board const& board, Player player) {
  */
 std::array<std::array<bool, Board::size>, Board::size> semi_stable_disks(
     Board const& board, Player player) {
+  PROFILE_TERM(term_semi_stable_disks);
   std::array<std::array<bool, Board::size>, Board::size> semi_stable;
 
   // initialize all disks as stable
@@ -313,6 +690,7 @@ std::array<std::array<bool, Board::size>, Board::size> stable_disks(
 
 //! Determines which player has the stability advantage.
 double stability(Board const& board, Player player) {
+  PROFILE_TERM(term_stability);
   double dark_score = 0;
   double light_score = 0;
 
@@ -354,6 +732,7 @@ double stability(Board const& board, Player player) {
 
 //! Calculates the relative amount of disks a player has.
 double disk_parity(Board const& board, Player player) {
+  PROFILE_TERM(term_disk_parity);
   double disk_diff = 0;
   for (size_t x = 0; x < board.size; x++) {
     for (size_t y = 0; y < board.size; y++) {
@@ -364,13 +743,16 @@ double disk_parity(Board const& board, Player player) {
   return player * disk_diff / board.disk_no();
 }
 
+int const static_values[Board::size][Board::size] = {
+    {+4, -3, +2, +2, +2, +2, -3, +4}, {-3, -4, -1, -1, -1, -1, -4, -3},
+    {+2, -1, +1, +0, +0, +1, -1, +2}, {+2, -1, +0, +1, +1, +0, -1, +2},
+    {+2, -1, +0, +1, +1, +0, -1, +2}, {+2, -1, +1, +0, +0, +1, -1, +2},
+    {-3, -4, -1, -1, -1, -1, -4, -3}, {+4, -3, +2, +2, +2, +2, -3, +4}};
+
 //! Rates the captured disks based on static disk values.
 double static_heuristic(Board const& board, Player player) {
-  double value[board.size][board.size] = {
-      {+4, -3, +2, +2, +2, +2, -3, +4}, {-3, -4, -1, -1, -1, -1, -4, -3},
-      {+2, -1, +1, +0, +0, +1, -1, +2}, {+2, -1, +0, +1, +1, +0, -1, +2},
-      {+2, -1, +0, +1, +1, +0, -1, +2}, {+2, -1, +1, +0, +0, +1, -1, +2},
-      {-3, -4, -1, -1, -1, -1, -4, -3}, {+4, -3, +2, +2, +2, +2, -3, +4}};
+  PROFILE_TERM(term_static_heuristic);
+  auto const& value = static_values;
 
   double dark_score = 0;
   double light_score = 0;
@@ -402,6 +784,7 @@ double static_heuristic(Board const& board, Player player) {
 
 //! Checks which player has the mobility advantage.
 double mobility(Board const& board, Player player) {
+  PROFILE_TERM(term_mobility);
   double dark_mobility = board.legal_moves(Player::dark).size();
   double light_mobility = board.legal_moves(Player::light).size();
 
@@ -1,8 +1,95 @@
 #ifndef REVERSI_MINIMAX_H_
 #define REVERSI_MINIMAX_H_
 
+#include <chrono>
+#include <vector>
 #include "board.hpp"
+#include "time_manager.hpp"
 
-Move minimax_actor(Board const& board, Player player);
+class LearningCache;
+
+Move minimax_actor(Board const& board, Player player, GameClock const& clock);
+
+/*! Sets the store of search results shared between games.
+ *
+ * Pass nullptr to search without a store.
+ */
+void set_learning_cache(LearningCache* cache);
+
+//! Result of the analysis of a single move.
+struct MoveAnalysis {
+  Move move;
+
+  //! Value of the move in the interval [-1, 1].
+  double value;
+
+  /*! The expected line of play, starting with the move itself.
+   *
+   * The learning cache only keeps the best move of a position, so the line
+   * ends early where the search used a result stored in the cache.
+   */
+  std::vector<Move> principal_variation;
+};
+
+/*! State of a single search.
+ *
+ * Every search has its own, so that several searches can run at once.
+ */
+struct SearchContext {
+  //! Point in time at which the search is abandoned.
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+
+  //! Set if the deadline has passed; results are meaningless then.
+  bool aborted = false;
+
+  //! Number of positions searched.
+  unsigned long long nodes = 0;
+};
+
+/*! Determines the k best moves, best first.
+ *
+ * All moves are ranked in a single iterative deepening search which ends
+ * after the given time or the given depth.  The first iteration is always
+ * completed; a later one still running when the time is up is abandoned.
+ * A time limit of steady_clock::duration::max() means no limit.
+ * If searched_nodes is given, it is set to the number of positions searched.
+ */
+std::vector<MoveAnalysis> minimax_analysis(
+    Board const& board, Player player, std::size_t k,
+    std::chrono::steady_clock::duration time_limit,
+    std::size_t max_depth = Board::size * Board::size,
+    unsigned long long* searched_nodes = nullptr);
+
+#ifdef REVERSI_PROFILE_TERMS
+#include <array>
+#include <atomic>
+
+//! Evaluation terms whose invocations are counted.
+enum Term {
+  term_heuristic,
+  term_corners_captured,
+  term_stability,
+  term_semi_stable_disks,
+  term_disk_parity,
+  term_static_heuristic,
+  term_mobility,
+  term_count
+};
+
+//! Printable names of the counted terms.
+extern char const* const term_names[term_count];
+
+/*! Number of invocations of each term since the program was started.
+ *
+ * The endgame solver evaluates positions from several threads.
+ */
+extern std::array<std::atomic<unsigned long long>, term_count> term_calls;
+
+#define PROFILE_TERM(term) \
+  (term_calls[term].fetch_add(1, std::memory_order_relaxed))
+#else
+#define PROFILE_TERM(term)
+#endif
 
 #endif
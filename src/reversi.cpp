@@ -1,6 +1,8 @@
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include "board.hpp"
+#include "reversi.hpp"
 
 std::ostream& operator<<(std::ostream& out, Board const& board) {
   // print column descriptors
@@ -38,6 +40,24 @@ std::ostream& operator<<(std::ostream& out, Board const& board) {
 Disk play_reversi(std::function<Move(Board const&, Player)> dark_actor,
                   std::function<Move(Board const&, Player)> light_actor,
                   bool verbose) {
+  // without a clock, the players have all the time in the world
+  GameClock const unlimited = {std::chrono::steady_clock::duration::max() / 2,
+                               std::chrono::steady_clock::duration::zero()};
+
+  return play_reversi(
+      [&dark_actor](Board const& board, Player player, GameClock const&) {
+        return dark_actor(board, player);
+      },
+      [&light_actor](Board const& board, Player player, GameClock const&) {
+        return light_actor(board, player);
+      },
+      unlimited, verbose);
+}
+
+Disk play_reversi(
+    std::function<Move(Board const&, Player, GameClock const&)> dark_actor,
+    std::function<Move(Board const&, Player, GameClock const&)> light_actor,
+    GameClock const& clock, bool verbose) {
   Board board;
 
   if (verbose) {
@@ -46,10 +66,27 @@ Disk play_reversi(std::function<Move(Board const&, Player)> dark_actor,
 
   Player player = Player::dark;  // the current player
 
+  GameClock dark_clock = clock;
+  GameClock light_clock = clock;
+
   while (true) {
+    Player opponent = (player == Player::dark) ? Player::light : Player::dark;
+    GameClock& player_clock =
+        (player == Player::dark) ? dark_clock : light_clock;
+
     // get the players move
-    Move move = (player == Player::dark) ? dark_actor(board, Player::dark)
-                                         : light_actor(board, Player::light);
+    auto move_start_time = std::chrono::steady_clock::now();
+    Move move = (player == Player::dark)
+                    ? dark_actor(board, Player::dark, dark_clock)
+                    : light_actor(board, Player::light, light_clock);
+
+    player_clock.remaining -=
+        std::chrono::steady_clock::now() - move_start_time;
+    if (player_clock.remaining < std::chrono::steady_clock::duration::zero()) {
+      // the player ran out of time
+      return opponent;
+    }
+    player_clock.remaining += player_clock.increment;
 
     if (boost::optional<Board> next_board = board.next_board(move, player)) {
       board = *next_board;
@@ -61,7 +98,6 @@ Disk play_reversi(std::function<Move(Board const&, Player)> dark_actor,
       std::cout << board;
     }
 
-    Player opponent = (player == Player::dark) ? Player::light : Player::dark;
     if (!board.legal_moves(opponent).empty()) {
       // the other player has to do a move
       player = opponent;
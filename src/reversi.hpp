@@ -3,9 +3,21 @@
 
 #include <functional>
 #include "board.hpp"
+#include "time_manager.hpp"
 
 Disk play_reversi(std::function<Move(Board const&, Player)> dark_actor,
                   std::function<Move(Board const&, Player)> light_actor,
                   bool verbose = false);
 
+/*! Plays a game in which each player has a game clock.
+ *
+ * Both clocks start with the given state.  The time a player takes for a move
+ * is charged to their clock, and the increment is added afterwards.  A player
+ * running out of time loses the game.
+ */
+Disk play_reversi(
+    std::function<Move(Board const&, Player, GameClock const&)> dark_actor,
+    std::function<Move(Board const&, Player, GameClock const&)> light_actor,
+    GameClock const& clock, bool verbose = false);
+
 #endif
@@ -0,0 +1,92 @@
+#include "time_manager.hpp"
+#include <algorithm>
+
+namespace {
+
+using Duration = std::chrono::steady_clock::duration;
+
+//! Expected ratio between the durations of consecutive iterations.
+double constexpr branch_fac = 8;
+
+//! Factor by which the soft budget grows when the best move changes.
+double constexpr instability_extension = 1.5;
+
+//! Value margin by which a move is considered clearly best.
+double constexpr clear_margin = 0.1;
+
+//! Number of iterations a clearly best move needs to be confirmed by.
+std::size_t constexpr clear_iterations = 3;
+
+//! Multiplies a duration, saturating at the longest one representable.
+Duration scale(Duration duration, double factor) {
+  std::chrono::duration<double, Duration::period> const product =
+      duration * factor;
+  if (product >= Duration::max()) {
+    return Duration::max();
+  }
+  return std::chrono::duration_cast<Duration>(product);
+}
+
+//! Adds two durations, saturating at the longest one representable.
+Duration add(Duration lhs, Duration rhs) {
+  return (rhs > Duration::max() - lhs) ? Duration::max() : lhs + rhs;
+}
+
+}  // namespace
+
+TimeManager::TimeManager(GameClock const& clock, Board const& board,
+                         Player player)
+    : _start(std::chrono::steady_clock::now()) {
+  std::size_t const empties = board.size * board.size - board.disk_no();
+  std::size_t const legal_moves = board.legal_moves(player).size();
+
+  // the player makes about every second of the remaining moves
+  std::size_t const moves_to_go = std::max<std::size_t>(1, (empties + 1) / 2);
+  Duration const base = add(clock.remaining / moves_to_go, clock.increment);
+
+  // the midgame decides most games; openings are mostly well-known
+  double phase_factor = 1;
+  if (empties > 44) {
+    phase_factor = 0.5;
+  } else if (empties > 16) {
+    phase_factor = 1.3;
+  }
+
+  // with few options, there is little to decide
+  double const choice_factor = (legal_moves <= 2) ? 0.5 : 1;
+
+  // never risk more than half of the clock on a single move
+  _hard = std::min(scale(base, 4), add(clock.remaining, clock.increment) / 2);
+  _soft = std::min(scale(base, phase_factor * choice_factor), _hard);
+}
+
+std::chrono::steady_clock::time_point TimeManager::hard_deadline() const {
+  return _start + _hard;
+}
+
+std::chrono::steady_clock::time_point TimeManager::soft_deadline() const {
+  return _start + _soft;
+}
+
+bool TimeManager::next_iteration(Move best_move, double margin,
+                                 Duration last_iteration) {
+  if (_best_move && *_best_move != best_move) {
+    // the search has not settled yet; give it more time
+    _soft = std::min(scale(_soft, instability_extension), _hard);
+    _stable_iterations = 0;
+  } else {
+    _stable_iterations++;
+  }
+  _best_move = best_move;
+
+  Duration const elapsed = std::chrono::steady_clock::now() - _start;
+
+  if (_stable_iterations >= clear_iterations && margin > clear_margin &&
+      elapsed > _soft / 4) {
+    // the move is clearly best; save the time for later moves
+    return false;
+  }
+
+  // an iteration which can not finish in time is wasted
+  return elapsed < _soft && scale(last_iteration, branch_fac) < _hard - elapsed;
+}
@@ -0,0 +1,57 @@
+#ifndef REVERSI_TIME_MANAGER_H_
+#define REVERSI_TIME_MANAGER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <boost/optional.hpp>
+#include "board.hpp"
+
+//! State of a player's game clock.
+struct GameClock {
+  //! Time left for the rest of the game.
+  std::chrono::steady_clock::duration remaining;
+
+  //! Time added to the clock after each move.
+  std::chrono::steady_clock::duration increment;
+};
+
+/*! Allocates the time of a game clock to a single move.
+ *
+ * Every move gets a soft budget, after which no new search iteration is
+ * started, and a hard budget, by which the search has to end.  Both depend
+ * on the number of moves left in the game and on the number of legal moves.
+ * The soft budget is extended while the best move keeps changing and cut
+ * short once one move is clearly best.
+ */
+class TimeManager {
+ public:
+  //! Starts timing the move of a player.
+  TimeManager(GameClock const& clock, Board const& board, Player player);
+
+  //! Point in time by which the search has to end.
+  std::chrono::steady_clock::time_point hard_deadline() const;
+
+  //! Point in time after which no new search should be started.
+  std::chrono::steady_clock::time_point soft_deadline() const;
+
+  /*! Decides whether to start another iteration.
+   *
+   * best_move is the best move found by the last iteration and margin the
+   * difference of its value to the one of the second best move.
+   */
+  bool next_iteration(Move best_move, double margin,
+                      std::chrono::steady_clock::duration last_iteration);
+
+ private:
+  std::chrono::steady_clock::time_point _start;
+  std::chrono::steady_clock::duration _soft;
+  std::chrono::steady_clock::duration _hard;
+
+  //! Best move of the previous iteration.
+  boost::optional<Move> _best_move;
+
+  //! Number of iterations in a row which found the same best move.
+  std::size_t _stable_iterations = 0;
+};
+
+#endif
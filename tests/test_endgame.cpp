@@ -0,0 +1,71 @@
+#define BOOST_TEST_MODULE test_endgame
+#include <cstdlib>
+#include <boost/test/included/unit_test.hpp>
+#include "endgame.hpp"
+#include "board.hpp"
+#include "minimax.hpp"
+
+double minimax_depth(SearchContext& context, Board const& board,
+                     Player player, size_t depth, double alpha, double beta,
+                     std::vector<Move>* principal_variation = nullptr);
+
+auto const no_deadline =
+    std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+//! Plays random moves until only the given number of squares is empty.
+std::pair<Board, Player> random_endgame(size_t empties) {
+  Board board;
+  Player player = Player::dark;
+
+  while (board.size * board.size - board.disk_no() > empties &&
+         !board.game_over()) {
+    Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+    auto moves = board.legal_moves(player);
+    if (!moves.empty()) {
+      board = *board.next_board(moves[rand() % moves.size()], player);
+    }
+    player = opponent;
+  }
+
+  if (board.legal_moves(player).empty()) {
+    player = (player == Disk::dark) ? Disk::light : Disk::dark;
+  }
+
+  return {board, player};
+}
+
+BOOST_AUTO_TEST_CASE(test_solve_endgame) {
+  for (int i = 0; i < 3; i++) {
+    Board board;
+    Player player;
+    std::tie(board, player) = random_endgame(9);
+    if (board.game_over()) {
+      continue;
+    }
+
+    auto sequential = solve_endgame(board, player, no_deadline);
+    BOOST_TEST(!!sequential);
+
+    // the exact value is the one of a full-depth minimax search
+    SearchContext context;
+    BOOST_TEST(sequential->value ==
+               minimax_depth(context, board, player,
+                             board.size * board.size - board.disk_no(), -1,
+                             1));
+
+    // parallel solving does not change the result
+    auto parallel = solve_endgame(board, player, no_deadline, 4);
+    BOOST_TEST(!!parallel);
+    BOOST_TEST(parallel->value == sequential->value);
+    BOOST_TEST((parallel->best_move == sequential->best_move));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_deadline) {
+  Board board;
+  Player player;
+  std::tie(board, player) = random_endgame(14);
+
+  BOOST_TEST(!solve_endgame(board, player, std::chrono::steady_clock::now(),
+                            2));
+}
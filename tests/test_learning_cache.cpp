@@ -0,0 +1,92 @@
+#define BOOST_TEST_MODULE test_learning_cache
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <boost/test/included/unit_test.hpp>
+#include "learning_cache.hpp"
+#include "board.hpp"
+
+char const* const path = "test_learning_cache.bin";
+
+BOOST_AUTO_TEST_CASE(test_store_probe) {
+  std::remove(path);
+  Board board = *Board().next_board({3, 2}, Disk::dark);
+
+  {
+    LearningCache cache(path, 64);
+    BOOST_TEST(!cache.probe(board, Disk::light));
+
+    cache.store(board, Disk::light,
+                {5, 0.25, LearningCache::Bound::exact, Move(2, 2)});
+
+    auto entry = cache.probe(board, Disk::light);
+    BOOST_TEST(!!entry);
+    BOOST_TEST(entry->depth == 5);
+    BOOST_TEST(entry->value == 0.25);
+    BOOST_TEST((entry->bound == LearningCache::Bound::exact));
+    BOOST_TEST((*entry->best_move == Move(2, 2)));
+
+    // the player to move is part of the position
+    BOOST_TEST(!cache.probe(board, Disk::dark));
+
+    // shallower results do not replace deeper ones
+    cache.store(board, Disk::light,
+                {3, -0.5, LearningCache::Bound::lower, boost::none});
+    BOOST_TEST(cache.probe(board, Disk::light)->depth == 5);
+  }
+
+  // the results outlive the process
+  LearningCache cache(path);
+  BOOST_TEST(cache.probe(board, Disk::light)->value == 0.25);
+
+  std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_symmetry) {
+  std::remove(path);
+  LearningCache cache(path, 64);
+
+  Board board = *Board().next_board({3, 2}, Disk::dark);
+  cache.store(board, Disk::light,
+              {5, 0.25, LearningCache::Bound::exact, Move(2, 2)});
+
+  // the same position, mirrored along the anti-diagonal
+  Board mirrored;
+  for (size_t x = 0; x < board.size; x++) {
+    for (size_t y = 0; y < board.size; y++) {
+      mirrored[board.size - 1 - y][board.size - 1 - x] = board[x][y];
+    }
+  }
+
+  auto entry = cache.probe(mirrored, Disk::light);
+  BOOST_TEST(!!entry);
+  BOOST_TEST((*entry->best_move == Move(5, 5)));
+
+  std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_replace_invalid_store) {
+  std::remove(path);
+  Board board = *Board().next_board({3, 2}, Disk::dark);
+
+  LearningCache old_cache(path, 64);
+  old_cache.store(board, Disk::light,
+                  {5, 0.25, LearningCache::Bound::exact, Move(2, 2)});
+
+  // make the file look like a store of another format version
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::uint64_t const version = 0xffff;
+    file.seekp(sizeof(std::uint64_t));
+    file.write(reinterpret_cast<char const*>(&version), sizeof(version));
+  }
+
+  // the invalid store is replaced by an empty one of a different size
+  LearningCache new_cache(path, 1024);
+  BOOST_TEST(!new_cache.probe(board, Disk::light));
+
+  // while the old one stays intact for the processes still using it
+  BOOST_TEST(old_cache.probe(board, Disk::light)->value == 0.25);
+
+  std::remove(path);
+}
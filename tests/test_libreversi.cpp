@@ -0,0 +1,130 @@
+#define BOOST_TEST_MODULE test_libreversi
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <boost/test/included/unit_test.hpp>
+#include "libreversi.h"
+
+BOOST_AUTO_TEST_CASE(test_abi_version) {
+  BOOST_TEST(reversi_abi_version() == REVERSI_ABI_VERSION);
+}
+
+BOOST_AUTO_TEST_CASE(test_play) {
+  reversi_board board;
+  reversi_board_init(&board);
+
+  uint8_t moves[REVERSI_SQUARES];
+  BOOST_TEST(reversi_legal_moves(&board, REVERSI_DARK, moves) == 4);
+
+  reversi_board next;
+  BOOST_TEST(!reversi_play(&board, REVERSI_DARK, 0, &next));
+  BOOST_TEST(reversi_play(&board, REVERSI_DARK, 3 * REVERSI_SIZE + 2, &next));
+  BOOST_TEST(next.squares[3 * REVERSI_SIZE + 2] == REVERSI_DARK);
+  BOOST_TEST(next.squares[3 * REVERSI_SIZE + 3] == REVERSI_DARK);
+
+  BOOST_TEST(!reversi_game_over(&next));
+}
+
+BOOST_AUTO_TEST_CASE(test_evaluate) {
+  // more boards than are converted at once
+  reversi_board boards[40];
+  reversi_board_init(&boards[0]);
+
+  // play the first legal move until the game is over
+  int player = REVERSI_DARK;
+  for (size_t i = 1; i < 40; i++) {
+    uint8_t moves[REVERSI_SQUARES];
+    if (!reversi_legal_moves(&boards[i - 1], player, moves)) {
+      player = -player;
+    }
+
+    if (reversi_legal_moves(&boards[i - 1], player, moves)) {
+      reversi_play(&boards[i - 1], player, moves[0], &boards[i]);
+      player = -player;
+    } else {
+      boards[i] = boards[i - 1];
+    }
+  }
+
+  double dark_values[40];
+  double light_values[40];
+  BOOST_TEST(reversi_evaluate(boards, 40, REVERSI_DARK, dark_values));
+  BOOST_TEST(reversi_evaluate(boards, 40, REVERSI_LIGHT, light_values));
+
+  for (size_t i = 0; i < 40; i++) {
+    BOOST_TEST(dark_values[i] >= -1);
+    BOOST_TEST(dark_values[i] <= 1);
+    BOOST_TEST(dark_values[i] == -light_values[i]);
+  }
+
+  // a square content is no player
+  double value = 2;
+  BOOST_TEST(!reversi_evaluate(boards, 1, REVERSI_NONE, &value));
+  BOOST_TEST(value == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_search) {
+  reversi_board board;
+  reversi_board_init(&board);
+
+  reversi_search_limits limits = {60, 3};
+  reversi_search_result results[8];
+  BOOST_TEST(reversi_search(&board, REVERSI_DARK, &limits, 8, results) == 4);
+
+  uint8_t moves[REVERSI_SQUARES];
+  size_t move_count = reversi_legal_moves(&board, REVERSI_DARK, moves);
+  for (int i = 0; i < 4; i++) {
+    BOOST_TEST(std::count(moves, moves + move_count, results[i].move) == 1);
+    BOOST_TEST(results[i].principal_variation_length == 3);
+    BOOST_TEST(results[i].principal_variation[0] == results[i].move);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_search_time_limit) {
+  reversi_board board;
+  reversi_board_init(&board);
+
+  // without a depth limit, only the time limit ends the search
+  reversi_search_limits limits = {0.5, 0};
+  reversi_search_result result;
+
+  auto start = std::chrono::steady_clock::now();
+  BOOST_TEST(reversi_search(&board, REVERSI_DARK, &limits, 1, &result) == 1);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  BOOST_TEST(elapsed.count() < 2 * limits.seconds);
+}
+
+BOOST_AUTO_TEST_CASE(test_search_unlimited_time) {
+  reversi_board board;
+  reversi_board_init(&board);
+  reversi_search_result result;
+
+  // infinite and overlong times leave only the depth limit
+  for (double seconds : {double(INFINITY), 1e300}) {
+    reversi_search_limits limits = {seconds, 2};
+    BOOST_TEST(reversi_search(&board, REVERSI_DARK, &limits, 1, &result) ==
+               1);
+    BOOST_TEST(result.principal_variation_length == 2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_search_invalid_arguments) {
+  reversi_board board;
+  reversi_board_init(&board);
+  reversi_search_limits limits = {1, 2};
+  reversi_search_result result;
+
+  for (double seconds : {-1.0, std::numeric_limits<double>::quiet_NaN()}) {
+    reversi_search_limits invalid = {seconds, 2};
+    BOOST_TEST(reversi_search(&board, REVERSI_DARK, &invalid, 1, &result) ==
+               -1);
+  }
+
+  BOOST_TEST(reversi_search(nullptr, REVERSI_DARK, &limits, 1, &result) ==
+             -1);
+  BOOST_TEST(reversi_search(&board, REVERSI_DARK, nullptr, 1, &result) == -1);
+  BOOST_TEST(reversi_search(&board, REVERSI_DARK, &limits, 1, nullptr) == -1);
+}
@@ -1,10 +1,16 @@
 #define BOOST_TEST_MODULE test_minimax
 #include <cstdlib>
+#include <limits>
 #include <boost/test/included/unit_test.hpp>
 #include "minimax.hpp"
+#include "batch_heuristic.hpp"
 #include "board.hpp"
 
 double heuristic(Board const& board, Player player);
+double heuristic(Board const& board, Player player, double alpha, double beta);
+double minimax_move(SearchContext& context, Board const& next_board,
+                    Player player, size_t depth, double alpha, double beta,
+                    std::vector<Move>* principal_variation = nullptr);
 
 BOOST_AUTO_TEST_CASE(test_heuristic) {
   Board board;
@@ -35,3 +41,128 @@ BOOST_AUTO_TEST_CASE(test_heuristic) {
     }
   }
 }
+
+BOOST_AUTO_TEST_CASE(test_heuristic_batch) {
+  Board board;
+
+  Player player = Player::dark;
+
+  // collect the boards of a random game of reversi
+  std::vector<Board> boards;
+  while (!board.game_over()) {
+    boards.push_back(board);
+
+    Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+    auto moves = board.legal_moves(player);
+    if (!moves.empty()) {
+      board = *board.next_board(moves[rand() % moves.size()], player);
+      player = opponent;
+    } else {
+      moves = board.legal_moves(opponent);
+      board = *board.next_board(moves[rand() % moves.size()], opponent);
+    }
+  }
+  boards.push_back(board);
+
+  // the batch has to rate every board exactly like the scalar heuristic
+  for (Player player : {Player::dark, Player::light}) {
+    std::vector<double> values(boards.size());
+    heuristic_batch(boards.data(), boards.size(), player, values.data());
+
+    for (size_t i = 0; i < boards.size(); i++) {
+      BOOST_TEST(values[i] == heuristic(boards[i], player));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_minimax_analysis) {
+  Board board;
+
+  // advance to an early midgame position
+  Player player = Player::dark;
+  for (int i = 0; i < 10; i++) {
+    board = *board.next_board(board.legal_moves(player)[0], player);
+    player = (player == Disk::dark) ? Disk::light : Disk::dark;
+  }
+
+  size_t const depth = 3;
+  size_t const k = 3;
+  auto ranking = minimax_analysis(board, player, k, std::chrono::hours(1),
+                                  depth);
+
+  BOOST_TEST(ranking.size() == k);
+
+  double constexpr infinity = std::numeric_limits<double>::infinity();
+  SearchContext context;
+  for (size_t i = 0; i < ranking.size(); i++) {
+    MoveAnalysis const& analysis = ranking[i];
+
+    // the moves are ranked best first
+    if (i > 0) {
+      BOOST_TEST(analysis.value <= ranking[i - 1].value);
+    }
+
+    // the values are exact
+    Board next_board = *board.next_board(analysis.move, player);
+    BOOST_TEST(analysis.value ==
+               minimax_move(context, next_board, player, depth - 1,
+                            -infinity, infinity));
+
+    BOOST_TEST(analysis.principal_variation.size() == depth);
+    BOOST_TEST((analysis.principal_variation[0] == analysis.move));
+  }
+
+  // no other move is better than the ranked ones
+  for (auto next : board.next_boards(player)) {
+    bool ranked = false;
+    for (MoveAnalysis const& analysis : ranking) {
+      ranked = ranked || analysis.move == next.first;
+    }
+
+    if (!ranked) {
+      BOOST_TEST(minimax_move(context, next.second, player, depth - 1,
+                              -infinity, infinity) <= ranking.back().value);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_heuristic_window) {
+  Board board;
+
+  Player player = Player::dark;
+
+  // play a random game of reversi; check windows around each rating
+  while (!board.game_over()) {
+    double value = heuristic(board, player);
+
+    for (double offset : {-0.5, -0.05, 0., 0.05, 0.5}) {
+      double alpha = value + offset - 0.01;
+      double beta = value + offset + 0.01;
+
+      double lazy_value = heuristic(board, player, alpha, beta);
+      double batch_value;
+      heuristic_batch(&board, 1, player, &batch_value, alpha, beta);
+
+      // either the exact rating or a bound outside of the window
+      for (double bound : {lazy_value, batch_value}) {
+        if (bound <= alpha) {
+          BOOST_TEST(value <= bound);
+        } else if (bound >= beta) {
+          BOOST_TEST(value >= bound);
+        } else {
+          BOOST_TEST(bound == value);
+        }
+      }
+    }
+
+    Player opponent = (player == Disk::dark) ? Disk::light : Disk::dark;
+    auto moves = board.legal_moves(player);
+    if (!moves.empty()) {
+      board = *board.next_board(moves[rand() % moves.size()], player);
+      player = opponent;
+    } else {
+      moves = board.legal_moves(opponent);
+      board = *board.next_board(moves[rand() % moves.size()], opponent);
+    }
+  }
+}
@@ -1,4 +1,5 @@
 #define BOOST_TEST_MODULE test_board
+#include <thread>
 #include <boost/test/included/unit_test.hpp>
 #include "reversi.hpp"
 #include "board.hpp"
@@ -12,3 +13,28 @@ BOOST_AUTO_TEST_CASE(test_reversi) {
 
   BOOST_TEST(play_reversi(simple_actor, simple_actor, true) == Disk::light);
 }
+
+Move timed_simple_actor(Board const& board, Player player, GameClock const&) {
+  return board.legal_moves(player)[0];
+}
+
+BOOST_AUTO_TEST_CASE(test_timed_reversi) {
+  GameClock clock = {std::chrono::seconds(10), std::chrono::seconds(1)};
+
+  BOOST_TEST(play_reversi(timed_simple_actor, timed_simple_actor, clock) ==
+             Disk::light);
+}
+
+BOOST_AUTO_TEST_CASE(test_time_out) {
+  GameClock clock = {std::chrono::milliseconds(10),
+                     std::chrono::milliseconds(0)};
+
+  // a player running out of time loses
+  auto slow_actor = [](Board const& board, Player player, GameClock const&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return board.legal_moves(player)[0];
+  };
+
+  BOOST_TEST(play_reversi(timed_simple_actor, slow_actor, clock) ==
+             Disk::dark);
+}
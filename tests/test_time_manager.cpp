@@ -0,0 +1,81 @@
+#define BOOST_TEST_MODULE test_time_manager
+#include <thread>
+#include <boost/test/included/unit_test.hpp>
+#include "time_manager.hpp"
+#include "board.hpp"
+
+BOOST_AUTO_TEST_CASE(test_budget) {
+  Board board;
+  GameClock clock = {std::chrono::minutes(10), std::chrono::seconds(5)};
+
+  auto start = std::chrono::steady_clock::now();
+  TimeManager time_manager(clock, board, Player::dark);
+
+  // the soft budget ends first, and no move takes more than half the clock
+  BOOST_TEST((time_manager.soft_deadline() <= time_manager.hard_deadline()));
+  BOOST_TEST((time_manager.soft_deadline() > start));
+  BOOST_TEST((time_manager.hard_deadline() <=
+              start + (clock.remaining + clock.increment) / 2 +
+                  std::chrono::seconds(1)));
+}
+
+BOOST_AUTO_TEST_CASE(test_low_clock) {
+  Board board;
+  GameClock clock = {std::chrono::seconds(1), std::chrono::seconds(0)};
+
+  auto start = std::chrono::steady_clock::now();
+  TimeManager time_manager(clock, board, Player::dark);
+
+  BOOST_TEST((time_manager.hard_deadline() <=
+              start + std::chrono::milliseconds(600)));
+}
+
+BOOST_AUTO_TEST_CASE(test_iterations) {
+  Board board;
+  GameClock clock = {std::chrono::seconds(10), std::chrono::seconds(0)};
+  TimeManager time_manager(clock, board, Player::dark);
+
+  // short iterations leave time for more
+  BOOST_TEST(time_manager.next_iteration({3, 2}, 0, std::chrono::seconds(0)));
+
+  // an iteration which can not end before the hard deadline is not started
+  BOOST_TEST(!time_manager.next_iteration({3, 2}, 0, std::chrono::hours(1)));
+
+  // a clearly best move is played without further thinking
+  for (int i = 0; i < 3; i++) {
+    time_manager.next_iteration({3, 2}, 1, std::chrono::seconds(0));
+  }
+  std::this_thread::sleep_for((time_manager.soft_deadline() -
+                               std::chrono::steady_clock::now()) /
+                              2);
+  BOOST_TEST(!time_manager.next_iteration({3, 2}, 1, std::chrono::seconds(0)));
+}
+
+BOOST_AUTO_TEST_CASE(test_unlimited_clock) {
+  // a board with four empty squares, where the clock is shared by few moves
+  Board board;
+  for (std::size_t x = 0; x < Board::size; x++) {
+    for (std::size_t y = 0; y < Board::size; y++) {
+      board[x][y] = (x + y) % 2 ? Disk::dark : Disk::light;
+    }
+  }
+  for (std::size_t y = 0; y < 4; y++) {
+    board[0][y] = Disk::none;
+  }
+
+  // play_reversi uses the first clock for games without a time limit
+  auto const max = std::chrono::steady_clock::duration::max();
+  auto const zero = std::chrono::steady_clock::duration::zero();
+  for (GameClock clock : {GameClock{max / 2, zero},
+                          GameClock{max / 2, max / 2}, GameClock{max, max}}) {
+    auto start = std::chrono::steady_clock::now();
+    TimeManager time_manager(clock, board, Player::dark);
+
+    // the budgets saturate instead of overflowing
+    BOOST_TEST((time_manager.soft_deadline() > start));
+    BOOST_TEST((time_manager.soft_deadline() <= time_manager.hard_deadline()));
+    BOOST_TEST((time_manager.hard_deadline() > start + std::chrono::hours(1)));
+    BOOST_TEST(
+        time_manager.next_iteration({0, 0}, 0, std::chrono::hours(1)));
+  }
+}